@@ -0,0 +1,258 @@
+/******************************************************************************
+* File Name     : 'bench.c'
+* Title         : Scheduler benchmark of mRTOS for the AVR simulator
+* Target MCU    : Atmel AVR series
+* Editor Tabs   : 4
+*
+* Notes:          Прошивка измерения производительности ядра (make bench).
+*                 Таймер T1 тактируется частотой процессора и служит
+*                 счётчиком тактов. Измеряются:
+*                   dispatch - переключение задач вызовом mRTOS_DISPATCH;
+*                   wait     - вызов mRTOS_TASK_WAIT(0) до возврата в задачу;
+*                   tick     - длительность обработчика системного тика;
+*                   event    - от прерывания T1 (mRTOS_SetEvent) до возврата
+*                              в задачу, ожидающую событие.
+*                 Результаты передаются через UART строками
+*                 "BENCH <ядро> <измерение> <задач> <мин.> <макс.>" (тактов;
+*                 ядро - значение mRTOS_USE_BITMAP_SCHEDULER), после
+*                 чего процессор засыпает с запрещёнными прерываниями
+*                 (симулятор завершает работу).
+*                 BENCH_SLEEPERS - количество дополнительных задач в списке
+*                 задержек; задач приложения mRTOS_APPLICATION_TASKS =
+*                 BENCH_SLEEPERS + 2 (задаётся при сборке).
+*
+* This code is distributed under the GNU Public License
+* which can be found at http://www.gnu.org/licenses/gpl.txt
+*******************************************************************************/
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include <stdlib.h>
+#include "mrtos.h"
+
+#if mRTOS_USE_STATIC_TASKS
+#error "bench: static task table is not supported, set mRTOS_USE_STATIC_TASKS to 0"
+#endif
+#if mRTOS_SYSTEM_TIMER == 1
+#error "bench: T1 is used for measurements, select another system timer"
+#endif
+#ifndef BENCH_SLEEPERS
+#define BENCH_SLEEPERS  0
+#endif
+#if mRTOS_APPLICATION_TASKS != (BENCH_SLEEPERS + 2)
+#error "bench: build with -DmRTOS_APPLICATION_TASKS=BENCH_SLEEPERS+2"
+#endif
+
+#define BENCH_SAMPLES   64      // количество измерений каждого вида
+#define BENCH_TICKS     32      // количество измеряемых системных тиков
+#define BENCH_GAP       64      // промежуток между чтениями T1 (тактов), считающийся прерыванием
+#define BENCH_EVENT     0       // номер события для измерения задержки от прерывания до задачи
+
+enum { BENCH_PHASE_DISPATCH, BENCH_PHASE_OTHER };
+
+static volatile uint8_t BenchPhase;            // текущий этап измерений
+static volatile uint8_t BenchArmed;            // признак начала измерения переключения
+static volatile uint16_t BenchStart;           // отсчёт T1 в начале измерения
+static volatile uint16_t BenchMin, BenchMax;   // результаты текущего измерения
+static uint16_t BenchOverhead;                 // длительность чтения T1 (вычитается из результатов)
+
+/**
+* Функция передачи символа через UART с ожиданием
+* входной параметр:
+* \param c - символ
+*/
+static void BenchPutChar(char c) {
+    while(!(UCSRA & _BV(UDRE)));
+    UDR = c;
+}
+
+/**
+* Функция передачи строки через UART
+* входной параметр:
+* \param s - строка
+*/
+static void BenchPutString(const char* s) {
+    while(*s)
+        BenchPutChar(*s++);
+}
+
+/**
+* Функция передачи числа через UART с предшествующим пробелом
+* входной параметр:
+* \param Value - число
+*/
+static void BenchPutNumber(uint16_t Value) {
+    char buf[6];
+    BenchPutChar(' ');
+    BenchPutString(utoa(Value, buf, 10));
+}
+
+/**
+* Функция передачи строки результата измерения
+* входной параметр:
+* \param Name - название измерения
+*/
+static void BenchReport(const char* Name) {
+    BenchPutString("BENCH");
+    BenchPutNumber(mRTOS_USE_BITMAP_SCHEDULER);
+    BenchPutChar(' ');
+    BenchPutString(Name);
+    BenchPutNumber(mRTOS_MAX_TASKS);
+    BenchPutNumber(BenchMin);
+    BenchPutNumber(BenchMax);
+    BenchPutChar('\n');
+}
+
+/**
+* Функция учёта результата одного измерения
+* входной параметр:
+* \param Cycles - длительность в тактах (с учётом чтения T1)
+*/
+static void BenchSample(uint16_t Cycles) {
+    Cycles -= BenchOverhead;
+    if(Cycles < BenchMin)
+        BenchMin = Cycles;
+    if(Cycles > BenchMax)
+        BenchMax = Cycles;
+}
+
+/**
+* Функция сброса результатов измерения
+*/
+static void BenchClear(void) {
+    BenchMin = 0xFFFF;
+    BenchMax = 0;
+}
+
+/**
+* Обработчик прерывания по совпадению T1: установка события
+*/
+ISR(TIMER1_COMPA_vect) {
+    mRTOS_SetEvent(BENCH_EVENT);
+}
+
+/**
+* Задача-партнёр измерения переключения: фиксирует время получения
+* управления после mRTOS_DISPATCH задачи bench_main
+*/
+static void bench_pong(void) {
+    while(1) {
+        if(BenchPhase != BENCH_PHASE_DISPATCH)
+            mRTOS_TASK_WAIT(0xFFFF);            // после этапа переключений не участвовать в измерениях
+        else {
+            if(BenchArmed) {
+                BenchSample(TCNT1 - BenchStart);
+                BenchArmed = 0;
+            }
+            mRTOS_DISPATCH;
+        }
+    }
+}
+
+/**
+* Задача, находящаяся в списке задержек (нагрузка для обработчика тика)
+*/
+static void bench_sleeper(void) {
+    while(1)
+        mRTOS_TASK_WAIT(0xFFFF);
+}
+
+/**
+* Задача измерений
+*/
+static void bench_main(void) {
+    static uint16_t prev, now, gap, loop;       // локальные переменные не сохраняются при переключении задач
+    static uint8_t i;
+
+    mRTOS_InitEvent(BENCH_EVENT);
+    TCCR1A = 0;
+    TCCR1B = _BV(CS10);                         // T1 - счётчик тактов процессора
+
+    BenchOverhead = 0xFFFF;                     // длительность чтения T1
+    for(i = 0; i < BENCH_SAMPLES; i++) {
+        prev = TCNT1;
+        now = TCNT1;
+        if((uint16_t)(now - prev) < BenchOverhead)
+            BenchOverhead = now - prev;
+    }
+
+    BenchClear();                               // переключение задач mRTOS_DISPATCH
+    for(i = 0; i < BENCH_SAMPLES; i++) {
+        BenchArmed = 1;
+        BenchStart = TCNT1;
+        mRTOS_DISPATCH;
+    }
+    BenchPhase = BENCH_PHASE_OTHER;
+    mRTOS_DISPATCH;                             // задача bench_pong переходит в ожидание
+    BenchReport("dispatch");
+
+    BenchClear();                               // mRTOS_TASK_WAIT(0) до возврата в задачу
+    for(i = 0; i < BENCH_SAMPLES; i++) {
+        BenchStart = TCNT1;
+        mRTOS_TASK_WAIT(0);
+        BenchSample(TCNT1 - BenchStart);
+    }
+    BenchReport("wait");
+
+    BenchClear();                               // обработчик системного тика (задача не отдаёт управление)
+    loop = 0xFFFF;
+    i = 0;
+    prev = TCNT1;
+    while(i < BENCH_TICKS) {
+        now = TCNT1;
+        gap = now - prev;
+        prev = now;
+        if(gap > BENCH_GAP) {                   // промежуток содержит обработчик прерывания
+            if(gap > BenchMax)
+                BenchMax = gap;
+            if(gap < BenchMin)
+                BenchMin = gap;
+            i++;
+        } else if(gap < loop)
+            loop = gap;                         // длительность цикла измерения без прерывания
+    }
+    BenchMin -= loop;
+    BenchMax -= loop;
+    BenchReport("tick");
+
+    BenchClear();                               // от прерывания до задачи, ожидающей событие
+    for(i = 0; i < BENCH_SAMPLES; i++) {
+        cli();
+        OCR1A = TCNT1 + 2000;
+        TIFR = _BV(OCF1A);
+        TIMSK |= _BV(OCIE1A);
+        sei();
+        mRTOS_EVENT_WAIT(BENCH_EVENT, 0);
+        now = TCNT1;
+        TIMSK &= ~_BV(OCIE1A);
+        mRTOS_GetEvent(BENCH_EVENT);
+        BenchStart = OCR1A;
+        BenchSample(now - BenchStart);
+    }
+    BenchReport("event");
+
+    cli();                                      // завершение работы симулятора
+    sleep_enable();
+    sleep_cpu();
+}
+
+int main(void) {
+    uint8_t i;
+
+    UBRRL = F_CPU / 16 / 38400 - 1;             // UART 38400 бод, только передача
+    UCSRB = _BV(TXEN);
+
+    TCCR0 = 0x00;
+    TCNT0 = 0x00;
+    TIMSK = _BV(TOIE0);
+    sei();
+
+    mRTOS_Init();
+    mRTOS_CreateTask(bench_main, 10, ACTIVE);
+    mRTOS_CreateTask(bench_pong, 10, ACTIVE);
+    for(i = 0; i < BENCH_SLEEPERS; i++)
+        mRTOS_CreateTask(bench_sleeper, 20, ACTIVE);
+    mRTOS_Scheduler();
+    return 0;
+}
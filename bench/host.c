@@ -0,0 +1,263 @@
+/******************************************************************************
+* File Name     : 'host.c'
+* Title         : Scheduler benchmark of mRTOS on the Linux host port
+* Target MCU    : Linux (host)
+* Editor Tabs   : 4
+*
+* Notes:          Измерение планировщика на рабочей станции (make bench-host,
+*                 порт mRTOS_PORT_HOST). Для каждого количества задач из
+*                 HostTasks выполняется HOST_RUNS сценариев, в каждом
+*                 сценарии ядро инициализируется заново, создаёт задачи и
+*                 выполняет HOST_SAMPLES измерений, после чего возвращается
+*                 в функцию main (mRTOS_PortExit). Измеряются (нс):
+*                   dispatch - от mRTOS_DISPATCH до получения управления
+*                              следующей задачей (задачи с равным
+*                              приоритетом, задача Idle выполняет тик);
+*                   wake     - от mRTOS_SetEvent до возврата в задачу,
+*                              ожидающую событие (mRTOS_EVENT_WAIT);
+*                   poll     - от mRTOS_SetEvent до обнаружения события
+*                              задачей, опрашивающей его (mRTOS_GetEvent и
+*                              mRTOS_DISPATCH, способ ожидания до
+*                              mRTOS_EVENT_WAIT); в измерениях wake и poll
+*                              остальные задачи готовы к выполнению и
+*                              только вызывают mRTOS_DISPATCH;
+*                   tick     - системный тик при задачах в списке задержек.
+*                 После строки заголовка "HOST core metric tasks samples
+*                 min p50 p99 max" результаты выводятся строками
+*                 "HOST <ядро> <измерение> <задач> <измерений> <мин.>
+*                 <медиана> <99%> <макс.>" (ядро - значение
+*                 mRTOS_USE_BITMAP_SCHEDULER), затем строкой
+*                 "HOST scenarios <сценариев> <сценариев в секунду>".
+*                 Количество задач приложения mRTOS_APPLICATION_TASKS
+*                 задаётся при сборке; сценарии с большим количеством задач
+*                 пропускаются (ядро с битовыми картами - не более 15 задач
+*                 приложения).
+*
+* This code is distributed under the GNU Public License
+* which can be found at http://www.gnu.org/licenses/gpl.txt
+*******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "mrtos_port.h"
+#include <inttypes.h>
+#include "mrtos.h"
+
+#if !mRTOS_PORT_HOST
+#error "bench: build with -DmRTOS_PORT_HOST=1"
+#endif
+
+#define HOST_SAMPLES    256     // количество измерений в сценарии
+#define HOST_RUNS       64      // количество сценариев каждого вида
+#define HOST_EVENT      0       // номер события для измерения пробуждения
+
+enum { HOST_DISPATCH, HOST_WAKE, HOST_POLL, HOST_TICK };
+
+static const uint8_t HostTasks[] = { 2, 4, 8, 15, 32, 64, 128 }; // количество задач приложения в сценариях
+
+static uint32_t HostResults[HOST_SAMPLES * HOST_RUNS]; // результаты измерений текущего вида
+static uint32_t HostCount;                  // количество результатов
+static uint16_t HostSamples;                // количество измерений текущего сценария
+static uint64_t HostStart;                  // время начала измерения
+static uint8_t HostArmed;                   // признак начала измерения
+static uint32_t HostOverhead;               // длительность чтения времени (вычитается из результатов)
+
+/**
+* Функция чтения времени
+* возвращает:
+* \return время в нс
+*/
+static uint64_t HostNow(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+/**
+* Функция учёта результата одного измерения; по окончании сценария
+* управление возвращается в функцию main
+* входной параметр:
+* \param Ns - длительность в нс (с учётом чтения времени)
+*/
+static void HostSample(uint64_t Ns) {
+    Ns = (Ns > HostOverhead) ? Ns - HostOverhead : 0;
+    HostResults[HostCount++] = Ns;
+    if(++HostSamples >= HOST_SAMPLES)
+        mRTOS_PortExit();
+}
+
+/**
+* Функция сравнения результатов для сортировки
+*/
+static int HostCompare(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+* Функция вывода строки результата измерения
+* входные параметры:
+* \param Name - название измерения;
+* \param Tasks - количество задач приложения.
+*/
+static void HostReport(const char* Name, uint8_t Tasks) {
+    qsort(HostResults, HostCount, sizeof(HostResults[0]), HostCompare);
+    printf("HOST %u %s %u %u %u %u %u %u\n", mRTOS_USE_BITMAP_SCHEDULER, Name, Tasks, HostCount,
+           HostResults[0], HostResults[HostCount / 2],
+           HostResults[HostCount * 99 / 100], HostResults[HostCount - 1]);
+}
+
+/**
+* Задача измерения переключения: фиксирует время получения управления
+* после mRTOS_DISPATCH предыдущей задачи
+*/
+static void host_dispatch(void) {
+    while(1) {
+        if(HostArmed)
+            HostSample(HostNow() - HostStart);
+        HostArmed = 1;
+        HostStart = HostNow();
+        mRTOS_DISPATCH;
+    }
+}
+
+/**
+* Задача, ожидающая событие
+*/
+static void host_waiter(void) {
+    mRTOS_InitEvent(HOST_EVENT);
+    HostArmed = 0;                          // событие разрешено, можно начинать измерения
+    while(1) {
+        mRTOS_EVENT_WAIT(HOST_EVENT, 0);
+        mRTOS_GetEvent(HOST_EVENT);
+        HostSample(HostNow() - HostStart);
+        HostArmed = 0;
+    }
+}
+
+/**
+* Задача, опрашивающая событие
+*/
+static void host_poller(void) {
+    mRTOS_InitEvent(HOST_EVENT);
+    HostArmed = 0;                          // событие разрешено, можно начинать измерения
+    while(1) {
+        if(mRTOS_GetEvent(HOST_EVENT)) {
+            HostSample(HostNow() - HostStart);
+            HostArmed = 0;
+        }
+        mRTOS_DISPATCH;
+    }
+}
+
+/**
+* Задача установки события (источник пробуждения)
+*/
+static void host_setter(void) {
+    while(1) {
+        if(!HostArmed) {
+            HostArmed = 1;
+            HostStart = HostNow();
+            mRTOS_SetEvent(HOST_EVENT);
+        }
+        mRTOS_DISPATCH;
+    }
+}
+
+/**
+* Задача, готовая к выполнению (нагрузка планировщика)
+*/
+static void host_busy(void) {
+    while(1)
+        mRTOS_DISPATCH;
+}
+
+/**
+* Задача измерения системного тика
+*/
+static void host_ticker(void) {
+    uint64_t start;
+    while(1) {
+        start = HostNow();
+        mRTOS_PortTick();
+        HostSample(HostNow() - start);
+        mRTOS_DISPATCH;
+    }
+}
+
+/**
+* Задача, находящаяся в списке задержек (задержки различны, чтобы задачи
+* не пробуждались во время измерения)
+*/
+static void host_sleeper(void) {
+    while(1)
+        mRTOS_TASK_WAIT(30000 + mRTOS_CurrentTask * 16);
+}
+
+/**
+* Функция выполнения одного сценария
+* входные параметры:
+* \param Kind - вид измерения;
+* \param Tasks - количество задач приложения.
+*/
+static void HostScenario(uint8_t Kind, uint8_t Tasks) {
+    uint8_t i;
+    mRTOS_Init();
+    HostSamples = 0;
+    HostArmed = 0;
+    switch(Kind) {
+    case HOST_DISPATCH:
+        for(i = 0; i < Tasks; i++)
+            mRTOS_CreateTask(host_dispatch, 10, ACTIVE);
+        break;
+    case HOST_WAKE:
+    case HOST_POLL:
+        HostArmed = 1;                      // до разрешения события задачей-получателем
+        mRTOS_CreateTask((Kind == HOST_WAKE) ? host_waiter : host_poller, 30, ACTIVE);
+        mRTOS_CreateTask(host_setter, 20, ACTIVE);
+        for(i = 2; i < Tasks; i++)
+            mRTOS_CreateTask(host_busy, 10, ACTIVE);
+        break;
+    default:
+        mRTOS_CreateTask(host_ticker, 20, ACTIVE);
+        for(i = 1; i < Tasks; i++)
+            mRTOS_CreateTask(host_sleeper, 10, ACTIVE);
+        break;
+    }
+    mRTOS_Scheduler();                      // возврат после HOST_SAMPLES измерений
+}
+
+int main(void) {
+    static const char* const names[] = { "dispatch", "wake", "poll", "tick" };
+    uint64_t start, prev, now;
+    uint32_t scenarios = 0;
+    uint8_t kind, i, r;
+
+    if(HostTasks[0] > mRTOS_APPLICATION_TASKS) {
+        fprintf(stderr, "bench: build with -DmRTOS_APPLICATION_TASKS=%u or more\n", HostTasks[0]);
+        return 1;
+    }
+    HostOverhead = 0xFFFFFFFF;              // длительность чтения времени
+    for(i = 0; i < 64; i++) {
+        prev = HostNow();
+        now = HostNow();
+        if(now - prev < HostOverhead)
+            HostOverhead = now - prev;
+    }
+
+    printf("HOST core metric tasks samples min p50 p99 max\n");
+    start = HostNow();
+    for(kind = HOST_DISPATCH; kind <= HOST_TICK; kind++)
+        for(i = 0; (i < sizeof(HostTasks)) && (HostTasks[i] <= mRTOS_APPLICATION_TASKS); i++) {
+            HostCount = 0;
+            for(r = 0; r < HOST_RUNS; r++) {
+                HostScenario(kind, HostTasks[i]);
+                scenarios++;
+            }
+            HostReport(names[kind], HostTasks[i]);
+        }
+    printf("HOST scenarios %u %u\n", scenarios,
+           (uint32_t)((uint64_t)scenarios * 1000000000u / (HostNow() - start)));
+    return 0;
+}
@@ -0,0 +1,219 @@
+/******************************************************************************
+* File Name     : 'sched.c'
+* Title         : Deadline miss benchmark of mRTOS scheduling policies
+* Target MCU    : Atmel AVR series, Linux (host)
+* Editor Tabs   : 4
+*
+* Notes:          Прошивка измерения пропусков сроков периодических задач
+*                 (make bench-sched). Три периодические задачи с периодами
+*                 10, 20 и 40 тиков выполняют работу длительностью 2.5, 4 и
+*                 8 тиков, умноженной на BENCH_LOAD / 100 (загрузка
+*                 процессора 0.65 * BENCH_LOAD / 100). Работа задаётся
+*                 ожиданием таймера T1 (тактируется F_CPU / 64). Через
+*                 BENCH_RUN тиков задача управления передаёт через UART для
+*                 каждой задачи строку "SCHED <политика> <загрузка> <задача>
+*                 <выпусков> <пропущено>", после чего процессор засыпает с
+*                 запрещёнными прерываниями (симулятор завершает работу).
+*                 На порте для Linux (make bench-sched-host,
+*                 mRTOS_PORT_HOST = 1) работа задачи выполняет тики
+*                 виртуальных часов (mRTOS_PortTick) по мере её
+*                 длительности, остаток тика переносится на следующую
+*                 работу (если между работами прошёл тик задачи Idle,
+*                 отсчёт начинается с начала тика); строки результатов
+*                 выводятся в стандартный вывод, после чего программа
+*                 завершается.
+*                 Набор задач для tools/mrtos_sched.py при BENCH_LOAD = 100:
+*                   fast 2.5 10
+*                   mid  4   20
+*                   slow 8   40
+*
+* This code is distributed under the GNU Public License
+* which can be found at http://www.gnu.org/licenses/gpl.txt
+*******************************************************************************/
+
+#include "mrtos_port.h"
+#if mRTOS_PORT_HOST
+#include <stdio.h>
+#else
+#include <avr/interrupt.h>
+#include <stdlib.h>
+#endif
+#include <inttypes.h>
+#include "mrtos.h"
+
+#if mRTOS_USE_STATIC_TASKS || !mRTOS_USE_PERIODIC_TASKS
+#error "bench: build with mRTOS_USE_STATIC_TASKS = 0 and mRTOS_USE_PERIODIC_TASKS = 1"
+#endif
+#if !mRTOS_PORT_HOST && (mRTOS_SYSTEM_TIMER == 1)
+#error "bench: T1 is used for measurements, select another system timer"
+#endif
+#if mRTOS_APPLICATION_TASKS != 4
+#error "bench: build with -DmRTOS_APPLICATION_TASKS=4"
+#endif
+#ifndef BENCH_LOAD
+#define BENCH_LOAD      100     // загрузка в процентах от базовой (0.65)
+#endif
+
+#define BENCH_RUN       4000    // длительность измерения в тиках
+
+static volatile uint16_t SchedReleases[3];      // количество выполненных выпусков задач
+
+#if mRTOS_PORT_HOST
+static uint16_t SchedPhase;                     // прошедшая часть текущего тика (тысячных тика)
+static uint32_t SchedTime;                      // системное время окончания предыдущей работы
+
+/**
+* Функция работы задачи: выполнение тиков виртуальных часов по мере
+* длительности работы (задача не отдаёт управление)
+* входной параметр:
+* \param Work10 - длительность работы в десятых тика (при BENCH_LOAD = 100)
+*/
+static void SchedWork(uint16_t Work10) {
+    if(mRTOS_GetSystemTime() != SchedTime)      // после простоя работа начинается с начала тика
+        SchedPhase = 0;
+    SchedPhase += Work10 * BENCH_LOAD;          // десятые тика * проценты = тысячные тика
+    while(SchedPhase >= 1000) {
+        SchedPhase -= 1000;
+        mRTOS_PortTick();
+    }
+    SchedTime = mRTOS_GetSystemTime();
+}
+
+/**
+* Функция вывода строки результатов задачи
+* входной параметр:
+* \param i - номер периодической задачи (0...2)
+*/
+static void SchedReport(uint8_t i) {
+    printf("SCHED %u %u %u %u %u\n", mRTOS_SCHEDULING_POLICY, BENCH_LOAD, i + 1,
+           SchedReleases[i], mRTOS_GetTaskMissed(i + 1));
+}
+#else
+#define BENCH_T1_TICK   (F_CPU / 64 / 1000) // отсчётов T1 за тик (тик 1 мс)
+#define BENCH_WORK(t10) ((uint16_t)((uint32_t)(t10) * BENCH_T1_TICK * BENCH_LOAD / 1000)) // работа t10 десятых тика
+
+/**
+* Функция передачи символа через UART с ожиданием
+* входной параметр:
+* \param c - символ
+*/
+static void SchedPutChar(char c) {
+    while(!(UCSRA & _BV(UDRE)));
+    UDR = c;
+}
+
+/**
+* Функция передачи строки через UART
+* входной параметр:
+* \param s - строка
+*/
+static void SchedPutString(const char* s) {
+    while(*s)
+        SchedPutChar(*s++);
+}
+
+/**
+* Функция передачи числа через UART с предшествующим пробелом
+* входной параметр:
+* \param Value - число
+*/
+static void SchedPutNumber(uint16_t Value) {
+    char buf[6];
+    SchedPutChar(' ');
+    SchedPutString(utoa(Value, buf, 10));
+}
+
+/**
+* Функция работы задачи: ожидание отсчётов T1 по длительности работы
+* (задача не отдаёт управление)
+* входной параметр:
+* \param Work10 - длительность работы в десятых тика (при BENCH_LOAD = 100)
+*/
+static void SchedWork(uint16_t Work10) {
+    uint16_t start = TCNT1;
+    while((uint16_t)(TCNT1 - start) < BENCH_WORK(Work10));
+}
+
+/**
+* Функция передачи строки результатов задачи через UART
+* входной параметр:
+* \param i - номер периодической задачи (0...2)
+*/
+static void SchedReport(uint8_t i) {
+    SchedPutString("SCHED");
+    SchedPutNumber(mRTOS_SCHEDULING_POLICY);
+    SchedPutNumber(BENCH_LOAD);
+    SchedPutNumber(i + 1);
+    SchedPutNumber(SchedReleases[i]);
+    SchedPutNumber(mRTOS_GetTaskMissed(i + 1));
+    SchedPutChar('\n');
+}
+#endif
+
+static void sched_fast(void) {
+    mRTOS_SetTaskPeriod(mRTOS_CurrentTask, 10);
+    while(1) {
+        SchedWork(25);
+        SchedReleases[0]++;
+        mRTOS_TASK_WAIT_PERIOD;
+    }
+}
+
+static void sched_mid(void) {
+    mRTOS_SetTaskPeriod(mRTOS_CurrentTask, 20);
+    while(1) {
+        SchedWork(40);
+        SchedReleases[1]++;
+        mRTOS_TASK_WAIT_PERIOD;
+    }
+}
+
+static void sched_slow(void) {
+    mRTOS_SetTaskPeriod(mRTOS_CurrentTask, 40);
+    while(1) {
+        SchedWork(80);
+        SchedReleases[2]++;
+        mRTOS_TASK_WAIT_PERIOD;
+    }
+}
+
+/**
+* Задача управления: передача результатов по окончании измерения
+*/
+static void sched_control(void) {
+    uint8_t i;
+    mRTOS_TASK_WAIT_UNTIL(BENCH_RUN);
+#if !mRTOS_PORT_HOST
+    cli();                                      // остановить задачи на время передачи
+#endif
+    for(i = 0; i < 3; i++)
+        SchedReport(i);
+#if mRTOS_PORT_HOST
+    mRTOS_PortExit();                           // возврат в функцию main
+#else
+    sleep_enable();                             // завершение работы симулятора
+    sleep_cpu();
+#endif
+}
+
+int main(void) {
+#if !mRTOS_PORT_HOST
+    UBRRL = F_CPU / 16 / 38400 - 1;             // UART 38400 бод, только передача
+    UCSRB = _BV(TXEN);
+
+    TCCR0 = 0x00;
+    TCNT0 = 0x00;
+    TCCR1A = 0;
+    TCCR1B = _BV(CS11) | _BV(CS10);             // T1 - F_CPU / 64
+    TIMSK = _BV(TOIE0);
+    sei();
+#endif
+
+    mRTOS_Init();
+    mRTOS_CreateTask(sched_fast, 30, ACTIVE);   // приоритеты - по частоте выпуска (rate monotonic)
+    mRTOS_CreateTask(sched_mid, 20, ACTIVE);
+    mRTOS_CreateTask(sched_slow, 10, ACTIVE);
+    mRTOS_CreateTask(sched_control, 40, ACTIVE);
+    mRTOS_Scheduler();
+    return 0;
+}
@@ -14,9 +14,12 @@ void task4(void) {
 }
 
 void task1(void) {
+    static uint32_t wake;               // момент следующего пробуждения (локальные переменные не сохраняются при переключении задач)
+    wake = mRTOS_GetSystemTime();
     while(1) {
         task4();
-        mRTOS_TASK_WAIT(100);
+        wake += 100;
+        mRTOS_TASK_WAIT_UNTIL(wake);    // период 100 тиков без накопления ошибки
 
     }
 }
@@ -101,7 +104,9 @@ int main(void) {
     sei();
 
     mRTOS_Init();
+#if !mRTOS_USE_STATIC_TASKS
     mRTOS_CreateTask(task1, 10, ACTIVE);
+#endif
     //mRTOS_CreateTask(task2, 20, ACTIVE);
     //mRTOS_CreateTask(task3, 20, ACTIVE);
     //mRTOSCreateTask(task5, 50, ACTIVE);
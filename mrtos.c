@@ -22,22 +22,817 @@
 * 07-Jan-2009   Movila V.N      1       Created the program structure
 *******************************************************************************/
 
-#include <avr/io.h>
+#include "mrtos_port.h"
 #include <inttypes.h>
-#include <util/atomic.h>
 #include "mrtos.h"
+#include "mrtos_trace.h"
+#include "mrtos_timer.h"
+#include "mrtos_stack.h"
+#include "mrtos_port_avr.h"
 
+#if mRTOS_USE_PACKED_TCB
+uint8_t mRTOS_TaskState[mRTOS_MAX_TASKS];           // состояния задач (WAIT | mRTOS_STATE_DELAYED - задержка не истекла)
+uint8_t mRTOS_TaskCredit[mRTOS_MAX_TASKS];          // текущие приоритеты (кредиты) задач
+uint8_t mRTOS_TaskPriority[mRTOS_MAX_TASKS];        // приоритеты задач
+struct TaskContext mRTOS_TaskContext[mRTOS_MAX_TASKS]; // контексты задач
+// перевод задачи n в состояние Wait на время d тиков (d = 0 - задержка истекла)
+#define mRTOS_TASK_SET_WAIT(n, d)  mRTOS_TaskState[n] = (d) ? (WAIT | mRTOS_STATE_DELAYED) : WAIT
+// задача n в состоянии Wait с истёкшей задержкой
+#define mRTOS_TASK_EXPIRED(n)      (mRTOS_TaskState[n] == WAIT)
+#else
 volatile struct TCB mRTOS_Tasks[mRTOS_MAX_TASKS]; // массив структур TCB всех задач приложения (Task Control Block)
+// перевод задачи n в состояние Wait на время d тиков (d = 0 - задержка истекла)
+#define mRTOS_TASK_SET_WAIT(n, d)  {mRTOS_Tasks[n].State = WAIT; mRTOS_Tasks[n].Delay = (d);}
+// задача n в состоянии Wait с истёкшей задержкой
+#define mRTOS_TASK_EXPIRED(n)      ((mRTOS_Tasks[n].State == WAIT) && (mRTOS_Tasks[n].Delay == 0))
+#endif
 uint8_t mRTOS_CurrentTask;                // номер текущей задачи
 static volatile struct ECB mRTOS_Events[mRTOS_MAX_EVENTS]; // массив структур ECB приложения (Event Task Control Block)
 static uint8_t mRTOS_InitTasksCounter,    // счётчик количества инициализированных задач в приложении
-mRTOS_Scheduler_pri,       // переменные планировщика задач
-mRTOS_Scheduler_i,
+mRTOS_FlagStart;           // флаг признака запуска mRTOS
+#if (mRTOS_SCHEDULING_POLICY == mRTOS_POLICY_CREDIT) && (mRTOS_USE_BITMAP_SCHEDULER || !mRTOS_USE_PACKED_TCB)
+static uint8_t mRTOS_Scheduler_i;         // переменная планировщика задач (перебор задач или уровень приоритета)
+#endif
+#if (mRTOS_SCHEDULING_POLICY == mRTOS_POLICY_CREDIT) && !mRTOS_USE_BITMAP_SCHEDULER && !mRTOS_USE_PACKED_TCB
+static uint8_t mRTOS_Scheduler_pri,       // переменные планировщика задач с перебором таблицы задач
 mRTOS_Scheduler_i_pri,
-mRTOS_FlagStart,           // флаг признака запуска mRTOS
 mRTOS_FlagSchedulerActive; // флаг планировщика задач
+#endif
 static volatile uint32_t mRTOS_SystemTime; // счётчик времени работы системы в системных тиках
 
+static volatile uint8_t mRTOS_TimeSequence; // счётчик последовательности: увеличивается при каждом изменении системного времени
+#if mRTOS_USE_TIME64
+static volatile uint32_t mRTOS_SystemTimeHigh; // старшая часть 64-разрядного системного времени
+#endif
+
+#if mRTOS_USE_BITMAP_SCHEDULER
+#if mRTOS_MAX_TASKS <= 8
+typedef uint8_t mRTOS_TaskMask;            // битовая карта задач (бит n - задача n)
+#define mRTOS_TASK_BIT(n)  pgm_read_byte(&mRTOS_MapTable[n])
+static const uint8_t mRTOS_MapTable[8] PROGMEM = { // таблица преобразования номера задачи в битовую маску
+    0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80
+};
+#else
+typedef uint16_t mRTOS_TaskMask;           // битовая карта задач (бит n - задача n)
+#define mRTOS_TASK_BIT(n)  pgm_read_word(&mRTOS_MapTable[n])
+static const uint16_t mRTOS_MapTable[16] PROGMEM = { // таблица преобразования номера задачи в битовую маску
+    0x0001, 0x0002, 0x0004, 0x0008, 0x0010, 0x0020, 0x0040, 0x0080,
+    0x0100, 0x0200, 0x0400, 0x0800, 0x1000, 0x2000, 0x4000, 0x8000
+};
+#endif
+#define mRTOS_PRIORITY_LEVELS    8 // количество уровней приоритета (Priority / 32)
+// номер бита уровня приоритета в группе готовности: младший бит - старший уровень
+#define mRTOS_PRIORITY_LEVEL(p)  ((mRTOS_PRIORITY_LEVELS - 1) - ((p) >> 5))
+#define mRTOS_LEVEL_BIT(l)       ((uint8_t)mRTOS_TASK_BIT(l))
+
+// таблица поиска номера младшего установленного бита в байте (для 0 - значение 0)
+static const uint8_t mRTOS_UnmapTable[256] PROGMEM = {
+    0, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0, // 0x00 - 0x0F
+    4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0, // 0x10 - 0x1F
+    5, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0, // 0x20 - 0x2F
+    4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0, // 0x30 - 0x3F
+    6, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0, // 0x40 - 0x4F
+    4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0, // 0x50 - 0x5F
+    5, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0, // 0x60 - 0x6F
+    4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0, // 0x70 - 0x7F
+    7, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0, // 0x80 - 0x8F
+    4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0, // 0x90 - 0x9F
+    5, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0, // 0xA0 - 0xAF
+    4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0, // 0xB0 - 0xBF
+    6, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0, // 0xC0 - 0xCF
+    4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0, // 0xD0 - 0xDF
+    5, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0, // 0xE0 - 0xEF
+    4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0  // 0xF0 - 0xFF
+};
+
+static volatile uint8_t mRTOS_ReadyGroup;                                  // битовая карта уровней приоритета, на которых есть задачи в состоянии Active
+static volatile mRTOS_TaskMask mRTOS_ReadyTable[mRTOS_PRIORITY_LEVELS],   // битовые карты задач в состоянии Active по уровням приоритета
+mRTOS_ServedTable[mRTOS_PRIORITY_LEVELS],                                 // битовые карты задач уровня, уже получивших управление в текущем круге
+mRTOS_ExpiredMask;                                                        // битовая карта задач в состоянии Wait с истёкшей задержкой
+static mRTOS_TaskMask mRTOS_Scheduler_mask;                               // переменная планировщика задач
+
+/**
+* Функция поиска номера младшего установленного бита в битовой карте задач
+* входной параметр:
+* \param Mask - битовая карта задач (не равна 0)
+* возвращает:
+* \return номер младшего установленного бита
+*/
+static inline uint8_t mRTOS_FindFirstTask(mRTOS_TaskMask Mask) {
+#if mRTOS_MAX_TASKS > 8
+    if((uint8_t)Mask == 0)                                       // если в младшем байте нет установленных битов, то
+        return 8 + pgm_read_byte(&mRTOS_UnmapTable[Mask >> 8]);  // искать в старшем байте
+#endif
+    return pgm_read_byte(&mRTOS_UnmapTable[(uint8_t)Mask]);
+}
+
+/**
+* Функция включения задачи в битовые карты готовности (вызывается при запрещённых прерываниях)
+* входной параметр:
+* \param TaskNumber - номер задачи
+*/
+static inline void mRTOS_ReadyInsert(uint8_t TaskNumber) {
+    uint8_t level = mRTOS_PRIORITY_LEVEL(mRTOS_TASK_PRIORITY(TaskNumber)); // уровень приоритета задачи
+    mRTOS_ReadyTable[level] |= mRTOS_TASK_BIT(TaskNumber);                   // отметить задачу как готовую на своём уровне
+    mRTOS_ReadyGroup |= mRTOS_LEVEL_BIT(level);                              // отметить уровень как имеющий готовые задачи
+}
+
+/**
+* Функция исключения задачи из битовых карт готовности (вызывается при запрещённых прерываниях)
+* входной параметр:
+* \param TaskNumber - номер задачи
+*/
+static inline void mRTOS_ReadyRemove(uint8_t TaskNumber) {
+    uint8_t level = mRTOS_PRIORITY_LEVEL(mRTOS_TASK_PRIORITY(TaskNumber)); // уровень приоритета задачи
+    if((mRTOS_ReadyTable[level] &= ~mRTOS_TASK_BIT(TaskNumber)) == 0)        // если на уровне не осталось готовых задач, то
+        mRTOS_ReadyGroup &= ~mRTOS_LEVEL_BIT(level);                         // снять отметку уровня
+}
+
+/**
+* Функция приведения битовых карт готовности в соответствие состоянию задачи
+* (вызывается при запрещённых прерываниях)
+* входной параметр:
+* \param TaskNumber - номер задачи
+*/
+static inline void mRTOS_ReadyUpdate(uint8_t TaskNumber) {
+    if(mRTOS_TASK_STATE(TaskNumber) == ACTIVE) // если задача в состоянии Active, то
+        mRTOS_ReadyInsert(TaskNumber);          // включить её в битовые карты готовности
+    else
+        mRTOS_ReadyRemove(TaskNumber);          // иначе исключить
+}
+#endif
+
+#if mRTOS_USE_PREEMPTIVE
+// --- вытесняющий режим: собственный стек каждой задачи ---
+static uint8_t mRTOS_Stacks[mRTOS_MAX_TASKS][mRTOS_TASK_STACK_SIZE]; // стеки задач
+static struct TaskContext mRTOS_StartContext;                      // контекст функции main до запуска mRTOS (не восстанавливается)
+static volatile struct TaskContext* mRTOS_CurrentContext __attribute__((used)) = &mRTOS_StartContext; // контекст текущей задачи (используется в ассемблерных вставках)
+static volatile uint8_t mRTOS_FlagWake;                            // флаг пробуждения задачи (запрос вытеснения в системном тике)
+#if mRTOS_TIME_SLICE
+static uint8_t mRTOS_SliceCounter;                                 // счётчик тиков кванта времени текущей задачи
+#endif
+#endif
+
+#if mRTOS_USE_STACK_SAVE
+// --- кооперативный режим с сохранением сегмента общего стека задачи ---
+static uint8_t mRTOS_StackSave[mRTOS_MAX_TASKS][mRTOS_STACK_SAVE_SIZE]; // области сохранения сегментов стека задач
+static uint8_t mRTOS_StackSaveLength[mRTOS_MAX_TASKS];              // длина сохранённого сегмента стека задачи
+static uint8_t mRTOS_StackSaveMax[mRTOS_MAX_TASKS];                 // наибольшая длина сегмента стека задачи (255 - переполнение)
+static uint16_t mRTOS_StackBase __attribute__((used));              // база задач: значение указателя стека при запуске mRTOS (0 - не запущена)
+static uint16_t mRTOS_StackSaveSP __attribute__((used));            // указатель стека задачи при переключении
+#endif
+
+#if mRTOS_USE_STACK_MONITOR && !mRTOS_USE_PREEMPTIVE
+// --- контроль стека в кооперативном режиме: наименьшие значения указателя стека ---
+static uint16_t mRTOS_StackTaskMin[mRTOS_MAX_TASKS];                // наименьший указатель стека задачи
+static uint16_t mRTOS_StackIsrMin;                                  // наименьший указатель стека в обработчике системного тика
+#define mRTOS_STACK_SAMPLE(Min, Sp) do { if((Sp) < (Min)) (Min) = (Sp); } while(0) // отметка указателя стека
+#else
+#define mRTOS_STACK_SAMPLE(Min, Sp)
+#endif
+
+// --- список задержек: задачи в состоянии Wait (и Semaphore с тайм-аутом), упорядоченные по времени пробуждения ---
+// Для каждой задачи списка хранится приращение задержки относительно предыдущей задачи,
+// поэтому обработчик системного тика уменьшает только задержку первой задачи списка.
+#define mRTOS_NO_TASK     0xFF                         // признак конца списка (нет задачи)
+#define mRTOS_NOT_LINKED  0xFE                         // признак задачи, не включённой в список задержек
+// Список изменяется только при запрещённых прерываниях, поэтому массивы объявлены без volatile.
+static volatile uint8_t mRTOS_DelayHead;               // номер первой задачи списка задержек
+static uint8_t  mRTOS_DelayNext[mRTOS_MAX_TASKS],      // номер следующей задачи списка задержек
+mRTOS_DelayPrev[mRTOS_MAX_TASKS];                      // номер предыдущей задачи списка задержек (mRTOS_NOT_LINKED - задачи нет в списке)
+static uint16_t mRTOS_DelayDelta[mRTOS_MAX_TASKS];     // приращение задержки относительно предыдущей задачи списка
+static const volatile void* mRTOS_WaitObject[mRTOS_MAX_TASKS]; // объект, ожидаемый задачей в состоянии Semaphore
+static uint8_t mRTOS_WaitNext[mRTOS_MAX_TASKS];        // номер следующей задачи списка ожидания семафора, мьютекса или группы событий
+static uint8_t mRTOS_MutexHeld[mRTOS_MAX_TASKS];       // задача владеет мьютексом (вложенный захват не поддерживается)
+#if mRTOS_USE_EVENT_GROUPS
+#define mRTOS_FLAGS_WAITING  0x80                      // признак задачи, включённой в список ожидания группы событий
+static mRTOS_EventFlags mRTOS_WaitFlags[mRTOS_MAX_TASKS]; // маска ожидаемых флагов группы событий (после пробуждения - результат ожидания)
+static uint8_t mRTOS_WaitMode[mRTOS_MAX_TASKS];        // режим ожидания флагов группы событий (mRTOS_FLAGS_xxx | mRTOS_FLAGS_WAITING)
+#endif
+#if mRTOS_USE_PERIODIC_TASKS
+static uint32_t mRTOS_TaskRelease[mRTOS_MAX_TASKS];    // момент последнего выпуска периодической задачи
+static uint16_t mRTOS_TaskPeriod[mRTOS_MAX_TASKS];     // период выпуска задачи в тиках (0 - задача не периодическая)
+static uint8_t mRTOS_TaskMissed[mRTOS_MAX_TASKS];      // количество пропущенных выпусков задачи (до 255)
+#endif
+#if mRTOS_USE_JOBS
+// --- задачи выполнения до завершения (jobs) ---
+static void (*mRTOS_JobFunction[mRTOS_MAX_JOBS])(void); // функции задач-jobs
+static uint8_t mRTOS_JobPriority[mRTOS_MAX_JOBS];     // приоритеты задач-jobs
+static uint16_t mRTOS_JobPeriod[mRTOS_MAX_JOBS];      // период выполнения задачи-job в тиках (0 - не периодическая)
+static uint16_t mRTOS_JobCounter[mRTOS_MAX_JOBS];     // тиков до следующего периодического выполнения
+static volatile uint8_t mRTOS_JobPending;             // битовая карта запрошенных задач-jobs
+static uint8_t mRTOS_InitJobsCounter;                 // количество созданных задач-jobs
+#endif
+#if mRTOS_USE_TASK_BUDGET
+static uint16_t mRTOS_TaskBudget[mRTOS_MAX_TASKS];     // бюджет времени выполнения задачи в тиках (0 - не задан)
+static uint16_t mRTOS_TaskRunMax[mRTOS_MAX_TASKS];     // наибольшая длительность выполнения задачи в тиках
+static uint8_t mRTOS_TaskOverruns[mRTOS_MAX_TASKS];    // количество превышений бюджета задачей (до 255)
+static uint16_t mRTOS_RunTicks;                        // длительность выполнения текущей задачи в тиках
+#define mRTOS_RUN_START() (mRTOS_RunTicks = 0)         // начало отсчёта длительности выполнения выбранной задачи
+#else
+#define mRTOS_RUN_START()
+#endif
+
+/**
+* Функция включения задачи в список задержек (вызывается при запрещённых
+* прерываниях вместе с переводом задачи в состояние ожидания, поэтому
+* системный тик не застаёт ожидающую задачу вне списка задержек)
+* входной параметр:
+* \param TaskNumber - номер задачи;
+* \param Delay - задержка в тиках (если задержка нулевая, то задача не
+*                включается).
+*/
+static void mRTOS_DelayInsert(uint8_t TaskNumber, uint16_t Delay) {
+    uint8_t prev, next;
+    uint16_t delay = Delay;
+    if(!delay)                                      // если задержка нулевая, то
+        return;                                     // выход
+    prev = mRTOS_NO_TASK;
+    next = mRTOS_DelayHead;
+    while((next != mRTOS_NO_TASK) && (delay >= mRTOS_DelayDelta[next])) { // поиск места задачи в списке (после задач с тем же временем пробуждения)
+        delay -= mRTOS_DelayDelta[next];
+        prev = next;
+        next = mRTOS_DelayNext[next];
+    }
+    mRTOS_DelayDelta[TaskNumber] = delay;           // приращение задержки относительно предыдущей задачи
+    mRTOS_DelayNext[TaskNumber] = next;
+    mRTOS_DelayPrev[TaskNumber] = prev;
+    if(next != mRTOS_NO_TASK) {                     // если за задачей есть следующая, то
+        mRTOS_DelayDelta[next] -= delay;            // уменьшить её приращение задержки
+        mRTOS_DelayPrev[next] = TaskNumber;
+    }
+    if(prev == mRTOS_NO_TASK)                       // если задача первая в списке, то
+        mRTOS_DelayHead = TaskNumber;
+    else
+        mRTOS_DelayNext[prev] = TaskNumber;
+}
+
+/**
+* Функция исключения задачи из списка задержек до истечения задержки
+* (вызывается при запрещённых прерываниях)
+* входной параметр:
+* \param TaskNumber - номер задачи
+*/
+static inline void mRTOS_DelayRemove(uint8_t TaskNumber) {
+    uint8_t prev = mRTOS_DelayPrev[TaskNumber],
+            next = mRTOS_DelayNext[TaskNumber];
+    if(prev == mRTOS_NOT_LINKED)                        // если задачи нет в списке, то
+        return;                                         // выход
+    if(next != mRTOS_NO_TASK) {                         // если за задачей есть следующая, то
+        mRTOS_DelayDelta[next] += mRTOS_DelayDelta[TaskNumber]; // передать ей приращение задержки
+        mRTOS_DelayPrev[next] = prev;
+    }
+    if(prev == mRTOS_NO_TASK)                           // если задача первая в списке, то
+        mRTOS_DelayHead = next;
+    else
+        mRTOS_DelayNext[prev] = next;
+    mRTOS_DelayPrev[TaskNumber] = mRTOS_NOT_LINKED;
+}
+
+#if mRTOS_USE_PREEMPTIVE
+/**
+* Функция проверки, что готовая к выполнению задача должна вытеснить текущую:
+* текущая задача - Idle, или приоритет задачи выше приоритета текущей задачи
+* (в ядре с битовыми картами - уровень приоритета, при политике EDF - более
+* ранний срок; задачи со сроком важнее задач без срока)
+* (вызывается при запрещённых прерываниях)
+* входной параметр:
+* \param TaskNumber - номер задачи
+* возвращает:
+* \return 1 - вытеснить текущую задачу
+* \return 0 - текущая задача продолжает выполнение
+*/
+static inline uint8_t mRTOS_Preempts(uint8_t TaskNumber) {
+    uint8_t current = mRTOS_CurrentTask;
+    if(current == 0)                                    // если выполняется задача Idle, то
+        return 1;                                       // вытеснить её
+#if mRTOS_SCHEDULING_POLICY == mRTOS_POLICY_EDF
+    if(mRTOS_TaskPeriod[TaskNumber] && mRTOS_TaskPeriod[current]) // если у обеих задач есть срок, то сравнить сроки
+        return mRTOS_TIME_BEFORE(mRTOS_TaskRelease[TaskNumber] + mRTOS_TaskPeriod[TaskNumber],
+                                 mRTOS_TaskRelease[current] + mRTOS_TaskPeriod[current]);
+    if(mRTOS_TaskPeriod[TaskNumber] || mRTOS_TaskPeriod[current]) // иначе важнее задача со сроком
+        return mRTOS_TaskPeriod[TaskNumber] != 0;
+#endif
+#if mRTOS_USE_BITMAP_SCHEDULER
+    return mRTOS_PRIORITY_LEVEL(mRTOS_TASK_PRIORITY(TaskNumber)) < mRTOS_PRIORITY_LEVEL(mRTOS_TASK_PRIORITY(current));
+#else
+    return mRTOS_TASK_PRIORITY(TaskNumber) > mRTOS_TASK_PRIORITY(current);
+#endif
+}
+#endif
+
+/**
+* Функция пробуждения задачи: задача переводится в состояние Wait с истёкшей
+* задержкой и получает управление при ближайшем вызове планировщика
+* (вызывается при запрещённых прерываниях)
+* входной параметр:
+* \param TaskNumber - номер задачи
+*/
+static inline void mRTOS_WakeTask(uint8_t TaskNumber) {
+    mRTOS_TASK_SET_WAIT(TaskNumber, 0);                 // задача в состоянии Wait с истёкшей задержкой
+#if mRTOS_USE_BITMAP_SCHEDULER
+    mRTOS_ExpiredMask |= mRTOS_TASK_BIT(TaskNumber);    // отметить задачу в битовой карте задач с истёкшей задержкой
+#endif
+#if mRTOS_USE_PREEMPTIVE
+    if(mRTOS_Preempts(TaskNumber))                      // если задача важнее текущей, то
+        mRTOS_FlagWake = 1;                             // запросить вытеснение текущей задачи
+#endif
+}
+
+/**
+* Функция перевода текущей задачи в состояние Wait на время Delay тиков с
+* включением в список задержек в одной критической секции (вызывается после
+* сохранения контекста задачи)
+* входной параметр:
+* \param Delay - задержка в тиках (0 - задержка истекла сразу)
+*/
+static void mRTOS_WaitBlock(uint16_t Delay) __attribute__((noinline));
+static void mRTOS_WaitBlock(uint16_t Delay) {
+    mRTOS_PORT_CRITICAL() {
+        mRTOS_TASK_SET_WAIT(mRTOS_CurrentTask, Delay); // установить состояние текущей задачи в Wait на время Delay (0 - задержка истекла)
+#if mRTOS_USE_BITMAP_SCHEDULER
+        mRTOS_ReadyRemove(mRTOS_CurrentTask);         // исключить текущую задачу из битовых карт готовности
+        if(Delay == 0)                                // если задержка нулевая, то
+            mRTOS_ExpiredMask |= mRTOS_TASK_BIT(mRTOS_CurrentTask); // задержка текущей задачи истекла сразу
+#endif
+        mRTOS_DelayInsert(mRTOS_CurrentTask, Delay);  // включить текущую задачу в список задержек
+    }
+}
+
+/**
+* Функция перевода текущей задачи в состояние Wait до момента системного
+* времени с включением в список задержек в одной критической секции
+* (задержка вычисляется при запрещённых прерываниях, поэтому тик между
+* вычислением и включением в список не теряется; вызывается после
+* сохранения контекста задачи)
+* входной параметр:
+* \param WakeTime - момент пробуждения в тиках (не далее 65535 тиков; если
+*                   момент уже наступил, задача пробуждается сразу).
+*/
+static void mRTOS_WaitBlockUntil(uint32_t WakeTime) __attribute__((noinline));
+static void mRTOS_WaitBlockUntil(uint32_t WakeTime) {
+    uint32_t delay;
+    mRTOS_PORT_CRITICAL() {
+        mRTOS_TASK_SET_WAIT(mRTOS_CurrentTask, 1);    // установить состояние текущей задачи в Wait (задержка уточняется ниже)
+#if mRTOS_USE_BITMAP_SCHEDULER
+        mRTOS_ReadyRemove(mRTOS_CurrentTask);         // исключить текущую задачу из битовых карт готовности
+#endif
+        if(!mRTOS_TIME_BEFORE(mRTOS_SystemTime, WakeTime)) { // если момент пробуждения наступил, то
+            mRTOS_WakeTask(mRTOS_CurrentTask);                // пробудить задачу
+        } else {
+            delay = WakeTime - mRTOS_SystemTime;
+            mRTOS_DelayInsert(mRTOS_CurrentTask, (delay > 0xFFFF) ? 0xFFFF : (uint16_t)delay);
+        }
+    }
+}
+
+#if mRTOS_USE_PERIODIC_TASKS
+/**
+* Функция вычисления момента следующего выпуска периодической задачи: если
+* задача не успела к выпуску, пропущенные выпуски подсчитываются и задача
+* выпускается в ближайший момент сетки периода, не ранее текущего времени
+* входной параметр:
+* \param TaskNumber - номер задачи
+* возвращает:
+* \return момент следующего выпуска в тиках
+*/
+static uint32_t mRTOS_NextRelease(uint8_t TaskNumber) __attribute__((noinline));
+static uint32_t mRTOS_NextRelease(uint8_t TaskNumber) {
+    uint32_t next, late;
+    uint16_t period;
+    mRTOS_PORT_CRITICAL() {
+        period = mRTOS_TaskPeriod[TaskNumber];
+        if(!period)                                       // если период не задан, то
+            next = mRTOS_SystemTime;                      // выпуск сразу
+        else {
+            next = mRTOS_TaskRelease[TaskNumber] + period;
+            if(mRTOS_TIME_BEFORE(next, mRTOS_SystemTime)) { // если момент выпуска прошёл, то
+                late = (mRTOS_SystemTime - next + period - 1) / period; // количество пропущенных выпусков
+                next += late * period;
+                mRTOS_TaskMissed[TaskNumber] = (late > 255 - mRTOS_TaskMissed[TaskNumber]) ? 255 : mRTOS_TaskMissed[TaskNumber] + late;
+            }
+            mRTOS_TaskRelease[TaskNumber] = next;
+        }
+    }
+    return next;
+}
+#endif
+
+#if mRTOS_USE_EVENT_GROUPS
+/**
+* Функция исключения задачи из списка ожидания группы событий по истечении
+* тайм-аута, результат ожидания - 0 (вызывается при запрещённых прерываниях)
+* входной параметр:
+* \param TaskNumber - номер задачи
+*/
+static void mRTOS_EventFlagsTimeout(uint8_t TaskNumber) {
+    uint8_t* LinkPtr = &((struct EventGroup*)mRTOS_WaitObject[TaskNumber])->WaitList;
+    while(*LinkPtr != TaskNumber)               // поиск задачи в списке ожидания группы
+        LinkPtr = &mRTOS_WaitNext[*LinkPtr];
+    *LinkPtr = mRTOS_WaitNext[TaskNumber];      // исключить задачу из списка
+    mRTOS_WaitMode[TaskNumber] = 0;
+    mRTOS_WaitFlags[TaskNumber] = 0;            // флаги не дождались
+}
+#endif
+
+/**
+* Функция отсчёта системных тиков в списке задержек с пробуждением задач,
+* задержка которых истекла (вызывается при запрещённых прерываниях)
+* входной параметр:
+* \param Ticks - количество прошедших системных тиков
+*/
+static inline void mRTOS_DelayTick(uint16_t Ticks) {
+    uint8_t i = mRTOS_DelayHead;
+    while(i != mRTOS_NO_TASK) {                 // цикл по задачам списка задержек
+        if(mRTOS_DelayDelta[i] > Ticks) {       // если задержка задачи не истекла, то
+            mRTOS_DelayDelta[i] -= Ticks;       // уменьшить её
+            mRTOS_DelayPrev[i] = mRTOS_NO_TASK; // задача становится первой в списке
+            break;                              // и выйти из цикла
+        }
+        Ticks -= mRTOS_DelayDelta[i];           // задержка задачи истекла
+        mRTOS_DelayPrev[i] = mRTOS_NOT_LINKED;  // исключить задачу из списка
+#if mRTOS_USE_EVENT_GROUPS
+        if(mRTOS_WaitMode[i] & mRTOS_FLAGS_WAITING) // если задача ожидает флаги группы событий, то
+            mRTOS_EventFlagsTimeout(i);         // исключить её из списка ожидания группы
+#endif
+        mRTOS_WakeTask(i);                      // пробудить задачу
+        i = mRTOS_DelayNext[i];
+    }
+    mRTOS_DelayHead = i;                        // исключить пробуждённые задачи из списка задержек
+}
+
+#if mRTOS_USE_JOBS
+/**
+* Функция отсчёта тиков периодических задач-jobs: при истечении периода
+* задача-job запрашивается (вызывается ядром при запрещённых прерываниях)
+* входной параметр:
+* \param Ticks - количество прошедших системных тиков
+*/
+static void mRTOS_JobTick(uint16_t Ticks) {
+    uint8_t i;
+    for(i = 0; i < mRTOS_InitJobsCounter; i++) {  // цикл по задачам-jobs
+        if(!mRTOS_JobPeriod[i])                   // пропустить не периодические задачи-jobs
+            continue;
+        if(mRTOS_JobCounter[i] > Ticks)           // если период не истёк, то
+            mRTOS_JobCounter[i] -= Ticks;         // уменьшить счётчик
+        else {
+            mRTOS_JobCounter[i] = mRTOS_JobPeriod[i]; // иначе начать новый период
+            mRTOS_JobPending |= 1 << i;           // и запросить выполнение
+        }
+    }
+}
+
+#if mRTOS_USE_TICKLESS_IDLE
+/**
+* Функция чтения задержки до ближайшего периодического выполнения задачи-job
+* (для режима без системного тика, вызывается при запрещённых прерываниях)
+* возвращает:
+* \return задержка в тиках (0xFFFF - нет периодических задач-jobs)
+*/
+static uint16_t mRTOS_JobDelay(void) {
+    uint16_t ticks = 0xFFFF;
+    uint8_t i;
+    for(i = 0; i < mRTOS_InitJobsCounter; i++)
+        if(mRTOS_JobPeriod[i] && (mRTOS_JobCounter[i] < ticks))
+            ticks = mRTOS_JobCounter[i];
+    return ticks;
+}
+#endif
+#endif
+
+#if mRTOS_USE_TICKLESS_IDLE && (mRTOS_SYSTEM_TIMER == 1)
+// Сон с таймером T1: период сравнения T1 (OCR1A) продлевается до ближайшего пробуждения задачи,
+// предделитель не изменяется, поэтому отсчёты T1 от начала периода - отсчёты основного предделителя.
+#define mRTOS_TICKLESS_MAX_TICKS (65535 / mRTOS_TICK_COUNTS - 1) // максимальная длительность сна в тиках
+#define mRTOS_TICKLESS_MARGIN    (16 / mRTOS_SYSTEM_TIMER_PRESCALER_RATIO + 2) // запас отсчётов T1 на запись OCR1A
+#define mRTOS_TICKLESS_FULL      (mRTOS_TicklessLength * mRTOS_TICK_COUNTS) // отсчёты T1 полного периода сна
+static volatile uint16_t mRTOS_TicklessLength; // длительность периода T1 в тиках (0 - сон не запущен, период - один тик)
+static uint16_t mRTOS_TicklessBase;            // тики периода T1, уже учтённые в системном времени
+
+/**
+* Функция чтения количества отсчётов T1, прошедших с начала периода сна
+* (вызывается при запрещённых прерываниях)
+* возвращает:
+* \return количество отсчётов
+*/
+static inline uint16_t mRTOS_TicklessElapsed(void) {
+    if(TIFR & _BV(OCF1A))                       // если период T1 уже истёк, то
+        return mRTOS_TICKLESS_FULL;             // интервал сна истёк полностью
+    return TCNT1;
+}
+
+/**
+* Функция пересчёта отсчётов T1 от начала периода сна в отсчёты от начала
+* первого ещё не учтённого тика
+* входной параметр:
+* \param Elapsed - количество отсчётов T1 от начала периода сна
+* возвращает:
+* \return количество отсчётов основного предделителя
+*/
+static inline uint16_t mRTOS_TicklessCounts(uint16_t Elapsed) {
+    return Elapsed - mRTOS_TicklessBase * mRTOS_TICK_COUNTS;
+}
+
+/**
+* Функция завершения сна: по истечении периода T1 восстанавливается период
+* в один тик, при пробуждении до его окончания период укорачивается до конца
+* текущего тика (отсчёт T1 не прерывается, фаза тика сохраняется); коррекция
+* системного времени и списка задержек (вызывается при запрещённых прерываниях)
+* входной параметр:
+* \param Elapsed - количество отсчётов T1, прошедших с начала периода сна
+*/
+static void mRTOS_TicklessStop(uint16_t Elapsed) {
+    uint16_t counts, ticks, next, top;
+    counts = mRTOS_TicklessCounts(Elapsed);
+    ticks = counts / mRTOS_TICK_COUNTS;         // количество целых тиков, прошедших с последнего учёта
+    if(Elapsed == mRTOS_TICKLESS_FULL) {        // если период сна истёк, то
+        OCR1A = mRTOS_TICK_COUNTS - 1;          // T1 уже считает следующий тик - восстановить период в один тик
+        TIFR = _BV(OCF1A);                      // сбросить флаг сравнения T1, если он ожидает обработки
+        mRTOS_TicklessLength = 0;
+        mRTOS_TicklessBase = 0;
+    } else {
+        next = mRTOS_TicklessBase + ticks + 1;  // период T1 завершается в конце текущего тика
+        top = next * mRTOS_TICK_COUNTS - 1;
+        while(TCNT1 + mRTOS_TICKLESS_MARGIN > top) { // если конец тика наступит раньше записи OCR1A, то
+            next++;                             // завершить период в конце следующего тика
+            top += mRTOS_TICK_COUNTS;
+        }
+        OCR1A = top;
+        mRTOS_TicklessLength = next;
+        mRTOS_TicklessBase += ticks;
+    }
+    mRTOS_SystemTime += ticks;                  // скорректировать системное время
+#if mRTOS_USE_TIME64
+    if(mRTOS_SystemTime < ticks)                // если счётчик тиков переполнился, то
+        mRTOS_SystemTimeHigh++;                 // увеличить старшую часть времени
+#endif
+    mRTOS_TimeSequence++;                       // системное время изменено
+    mRTOS_DelayTick(ticks);                     // и задержки задач
+#if mRTOS_USE_TIMERS
+    mRTOS_TimerTick(ticks);                     // и программных таймеров
+#endif
+#if mRTOS_USE_JOBS
+    mRTOS_JobTick(ticks);                       // и периодических задач-jobs
+#endif
+}
+#elif mRTOS_USE_TICKLESS_IDLE
+#define mRTOS_TICKLESS_MAX_TICKS ((255 * mRTOS_TICKLESS_TIMER_PRESCALER_RATIO) / mRTOS_TICK_COUNTS) // максимальная длительность сна в тиках
+#define mRTOS_TICKLESS_FULL      mRTOS_TicklessLength // отсчёты T0 полного интервала сна
+static volatile uint8_t mRTOS_TicklessLength;  // длительность сна в отсчётах T0 предделителя сна (0 - сон не запущен)
+static uint8_t mRTOS_TicklessStart;            // число отсчётов основного предделителя, прошедших в текущем тике до начала сна
+
+/**
+* Функция чтения количества отсчётов T0 предделителя сна, прошедших с
+* начала сна (вызывается при запрещённых прерываниях)
+* возвращает:
+* \return количество отсчётов
+*/
+static inline uint8_t mRTOS_TicklessElapsed(void) {
+    uint8_t elapsed = TCNT0 + mRTOS_TicklessLength;
+    if(TIFR & _BV(TOV0))                        // если T0 уже переполнился, то
+        elapsed = mRTOS_TicklessLength;         // интервал сна истёк полностью
+    return elapsed;
+}
+
+/**
+* Функция пересчёта отсчётов предделителя сна в отсчёты основного
+* предделителя с начала тика, в котором начался сон
+* входной параметр:
+* \param Elapsed - количество отсчётов предделителя сна
+* возвращает:
+* \return количество отсчётов основного предделителя
+*/
+static inline uint16_t mRTOS_TicklessCounts(uint8_t Elapsed) {
+    return mRTOS_TicklessStart + (uint16_t)Elapsed * mRTOS_TICKLESS_TIMER_PRESCALER_RATIO;
+}
+
+/**
+* Функция завершения сна: возврат T0 к основному предделителю, коррекция
+* системного времени и списка задержек (вызывается при запрещённых прерываниях)
+* входной параметр:
+* \param Elapsed - количество отсчётов предделителя сна, прошедших с начала сна
+*/
+static void mRTOS_TicklessStop(uint8_t Elapsed) {
+    uint16_t counts, ticks;
+    TCCR0 = 0;                                  // остановить системный таймер
+    TIFR = _BV(TOV0);                           // сбросить флаг переполнения T0, если он ожидает обработки
+    counts = mRTOS_TicklessCounts(Elapsed);
+    mRTOS_TicklessLength = 0;
+    ticks = counts / mRTOS_TICK_COUNTS;         // количество целых тиков, прошедших за время сна
+    TCNT0 = mRTOS_SYSTEM_TIMER_RELOAD_VALUE + (uint8_t)(counts - ticks * mRTOS_TICK_COUNTS); // остаток продолжает текущий тик
+    SFIOR |= _BV(PSR10);                        // сбросить предделитель T0 (и T1)
+    TCCR0 = mRTOS_SYSTEM_TIMER_PRESCALER_VALUE; // запустить системный таймер с основным предделителем
+    mRTOS_SystemTime += ticks;                  // скорректировать системное время
+#if mRTOS_USE_TIME64
+    if(mRTOS_SystemTime < ticks)                // если счётчик тиков переполнился, то
+        mRTOS_SystemTimeHigh++;                 // увеличить старшую часть времени
+#endif
+    mRTOS_TimeSequence++;                       // системное время изменено
+    mRTOS_DelayTick(ticks);                     // и задержки задач
+#if mRTOS_USE_TIMERS
+    mRTOS_TimerTick(ticks);                     // и программных таймеров
+#endif
+#if mRTOS_USE_JOBS
+    mRTOS_JobTick(ticks);                       // и периодических задач-jobs
+#endif
+}
+#endif
+
+/**
+* Функция чтения количества тиков, прошедших после последнего изменения
+* системного времени (прерывание тика ожидает обработки или задача Idle в
+* режиме сна), и отсчётов таймера от начала текущего тика. Вызывается при
+* запрещённых прерываниях или в цикле чтения со счётчиком последовательности.
+* входной параметр:
+* \param CountsPtr - указатель на переменную для отсчётов таймера от начала тика
+* возвращает:
+* \return количество тиков, не учтённых в mRTOS_SystemTime
+*/
+static inline uint16_t mRTOS_PendingTicks(uint8_t* CountsPtr) {
+#if mRTOS_USE_TICKLESS_IDLE
+    uint16_t ticks, counts;
+    if(mRTOS_TicklessLength) {                  // если задача Idle в режиме сна, то
+        counts = mRTOS_TicklessCounts(mRTOS_TicklessElapsed()); // отсчёты основного предделителя с начала тика, в котором начался сон
+        ticks = counts / mRTOS_TICK_COUNTS;
+        *CountsPtr = counts - ticks * mRTOS_TICK_COUNTS;
+        return ticks;
+    }
+#endif
+    return mRTOS_PortTickCounts(CountsPtr);     // тик, ожидающий обработки, и отсчёты таймера порта
+}
+
+#if mRTOS_USE_PREEMPTIVE
+// В вытесняющем режиме контекст задачи сохраняется в её стеке при переключении задач
+// функцией планировщика, поэтому функции ожидания только изменяют состояние задачи.
+#define mRTOS_SAVE_RETURN_CONTEXT(TaskContextPtr) ((void)(TaskContextPtr))
+
+// Сохранение регистров r0...r31 и SREG в стеке текущей задачи и указателя стека в структуре
+// контекста текущей задачи; прерывания запрещаются (79 тактов).
+#define mRTOS_SAVE_CONTEXT() \
+        asm volatile( \
+                    "push r0"                       "\n\t" /* сохранить регистр r0 */ \
+                    "in   r0, __SREG__"             "\n\t" /* прочитать регистр SREG */ \
+                    "cli"                           "\n\t" /* запретить прерывания */ \
+                    "push r0"                       "\n\t" /* сохранить регистр SREG */ \
+                    "push r1"                       "\n\t" /* сохранить регистр r1 */ \
+                    "clr  r1"                       "\n\t" /* r1 должен быть всегда 0 */ \
+                    "push r2"                      "\n\t" \
+                    "push r3"                      "\n\t" \
+                    "push r4"                      "\n\t" \
+                    "push r5"                      "\n\t" \
+                    "push r6"                      "\n\t" \
+                    "push r7"                      "\n\t" \
+                    "push r8"                      "\n\t" \
+                    "push r9"                      "\n\t" \
+                    "push r10"                     "\n\t" \
+                    "push r11"                     "\n\t" \
+                    "push r12"                     "\n\t" \
+                    "push r13"                     "\n\t" \
+                    "push r14"                     "\n\t" \
+                    "push r15"                     "\n\t" \
+                    "push r16"                     "\n\t" \
+                    "push r17"                     "\n\t" \
+                    "push r18"                     "\n\t" \
+                    "push r19"                     "\n\t" \
+                    "push r20"                     "\n\t" \
+                    "push r21"                     "\n\t" \
+                    "push r22"                     "\n\t" \
+                    "push r23"                     "\n\t" \
+                    "push r24"                     "\n\t" \
+                    "push r25"                     "\n\t" \
+                    "push r26"                     "\n\t" \
+                    "push r27"                     "\n\t" \
+                    "push r28"                     "\n\t" \
+                    "push r29"                     "\n\t" \
+                    "push r30"                     "\n\t" \
+                    "push r31"                     "\n\t" \
+                    "lds  r26, mRTOS_CurrentContext"   "\n\t" /* прочитать адрес структуры контекста текущей задачи в X */ \
+                    "lds  r27, mRTOS_CurrentContext+1" "\n\t" \
+                    "in   r0, __SP_L__"             "\n\t" /* сохранить указатель стека в структуре контекста задачи */ \
+                    "st   X+, r0"                   "\n\t" \
+                    "in   r0, __SP_H__"             "\n\t" \
+                    "st   X+, r0"                   "\n\t" \
+                    )
+
+// Восстановление указателя стека из структуры контекста текущей задачи и регистров
+// r31...r0 и SREG из стека задачи (77 тактов); после вызывается ret или reti.
+#define mRTOS_RESTORE_CONTEXT() \
+        asm volatile( \
+                    "lds  r26, mRTOS_CurrentContext"   "\n\t" /* прочитать адрес структуры контекста текущей задачи в X */ \
+                    "lds  r27, mRTOS_CurrentContext+1" "\n\t" \
+                    "ld   r28, X+"                  "\n\t" /* восстановить указатель стека задачи */ \
+                    "out  __SP_L__, r28"            "\n\t" \
+                    "ld   r29, X+"                  "\n\t" \
+                    "out  __SP_H__, r29"            "\n\t" \
+                    "pop  r31"                     "\n\t" \
+                    "pop  r30"                     "\n\t" \
+                    "pop  r29"                     "\n\t" \
+                    "pop  r28"                     "\n\t" \
+                    "pop  r27"                     "\n\t" \
+                    "pop  r26"                     "\n\t" \
+                    "pop  r25"                     "\n\t" \
+                    "pop  r24"                     "\n\t" \
+                    "pop  r23"                     "\n\t" \
+                    "pop  r22"                     "\n\t" \
+                    "pop  r21"                     "\n\t" \
+                    "pop  r20"                     "\n\t" \
+                    "pop  r19"                     "\n\t" \
+                    "pop  r18"                     "\n\t" \
+                    "pop  r17"                     "\n\t" \
+                    "pop  r16"                     "\n\t" \
+                    "pop  r15"                     "\n\t" \
+                    "pop  r14"                     "\n\t" \
+                    "pop  r13"                     "\n\t" \
+                    "pop  r12"                     "\n\t" \
+                    "pop  r11"                     "\n\t" \
+                    "pop  r10"                     "\n\t" \
+                    "pop  r9"                      "\n\t" \
+                    "pop  r8"                      "\n\t" \
+                    "pop  r7"                      "\n\t" \
+                    "pop  r6"                      "\n\t" \
+                    "pop  r5"                      "\n\t" \
+                    "pop  r4"                      "\n\t" \
+                    "pop  r3"                      "\n\t" \
+                    "pop  r2"                      "\n\t" \
+                    "pop  r1"                       "\n\t" /* восстановить регистр r1 */ \
+                    "pop  r0"                       "\n\t" /* восстановить регистр SREG */ \
+                    "out  __SREG__, r0"             "\n\t" \
+                    "pop  r0"                       "\n\t" /* восстановить регистр r0 */ \
+                    )
+
+/**
+* Функция подготовки стека задачи: в стек записывается адрес точки входа
+* в задачу и начальные значения регистров в порядке mRTOS_SAVE_CONTEXT
+* входные параметры:
+* \param Task - указатель на функцию задачи;
+* \param TaskNumber - номер задачи.
+*/
+static void mRTOS_InitStack(void (*Task)(void), uint8_t TaskNumber) {
+    uint8_t* StackPtr = &mRTOS_Stacks[TaskNumber][mRTOS_TASK_STACK_SIZE - 1]; // вершина стека задачи
+    uint8_t i;
+#if mRTOS_USE_STACK_MONITOR
+    uint16_t j;
+    for(j = 0; j < mRTOS_TASK_STACK_SIZE; j++) // окрасить стек задачи
+        mRTOS_Stacks[TaskNumber][j] = mRTOS_STACK_PAINT;
+#endif
+    *StackPtr-- = (uint16_t)Task;             // мл. байт адреса точки входа в задачу (извлекается командой ret)
+    *StackPtr-- = (uint16_t)Task >> 8;        // ст. байт адреса точки входа в задачу
+    *StackPtr-- = 0;                          // регистр r0
+    *StackPtr-- = 0x80;                       // регистр SREG (прерывания разрешены)
+    for(i = 1; i < 32; i++)                   // регистры r1...r31 (r1 должен быть 0)
+        *StackPtr-- = 0;
+    mRTOS_TASK_CONTEXT(TaskNumber).StackPointer = (uint16_t)StackPtr; // указатель стека указывает на первый свободный байт
+}
+
+#elif mRTOS_USE_STACK_SAVE
+// Контекст задачи сохраняется в её сегменте стека функцией планировщика,
+// поэтому функции ожидания только изменяют состояние задачи.
+#define mRTOS_SAVE_RETURN_CONTEXT(TaskContextPtr) ((void)(TaskContextPtr))
+
+/**
+* Функция подготовки сегмента стека задачи: в область сохранения записывается
+* кадр запуска задачи в порядке извлечения из стека функцией планировщика
+* (SREG, r29, r28, r17...r2, адрес точки входа в задачу)
+* входные параметры:
+* \param Task - указатель на функцию задачи;
+* \param TaskNumber - номер задачи.
+*/
+static void mRTOS_InitStackSave(void (*Task)(void), uint8_t TaskNumber) {
+    uint8_t i;
+    mRTOS_StackSave[TaskNumber][0] = 0x80;    // регистр SREG (прерывания разрешены)
+    for(i = 1; i < 19; i++)                   // регистры r29, r28, r17...r2
+        mRTOS_StackSave[TaskNumber][i] = 0;
+    mRTOS_StackSave[TaskNumber][19] = (uint16_t)Task >> 8; // ст. байт адреса точки входа в задачу
+    mRTOS_StackSave[TaskNumber][20] = (uint16_t)Task;      // мл. байт адреса точки входа в задачу (извлекается командой ret)
+    mRTOS_StackSaveLength[TaskNumber] = 21;
+    mRTOS_StackSaveMax[TaskNumber] = 21;
+}
+
+#elif mRTOS_PORT_HOST
+// Порт для Linux: контекст задачи сохраняется функцией переключения порта,
+// поэтому функции ожидания только изменяют состояние задачи.
+#define mRTOS_SAVE_RETURN_CONTEXT(TaskContextPtr) ((void)(TaskContextPtr))
+
+#else
+// Сохранение адреса возврата в задачу (с вершины стека) и регистра SREG в структуре
+// контекста задачи; используется в функциях перевода задачи в состояние ожидания.
+// Адрес возврата находится на вершине стека, только если компилятор не создал пролог функции
+// ожидания (push, кадр стека); это проверяется после сборки по листингу (tools/mrtos_entry.py).
+#define mRTOS_SAVE_RETURN_CONTEXT(TaskContextPtr) \
+        asm volatile( \
+                    "movw r26, %A0"                 "\n\t" /* сохранить адрес структуры контекста задачи в X */ \
+                    "pop  __tmp_reg__"              "\n\t" /* прочитать ст. байт адреса возврата из стека */ \
+                    "pop  __zero_reg__"             "\n\t" /* прочитать мл. байт адреса возврата из стека */ \
+                    "st   X+, __zero_reg__"         "\n\t" /* сохранить мл. байт адреса возврата в структуре контекста задачи */ \
+                    "st   X+, __tmp_reg__"          "\n\t" /* сохранить ст. байт адреса возврата в структуре контекста задачи */ \
+                    "in   __tmp_reg__, __SREG__"    "\n\t" /* прочитать регистр SREG */ \
+                    "st   X, __tmp_reg__"           "\n\t" /* сохранить регистр SREG в структуре контекста задачи */ \
+                    "clr  __zero_reg__"             "\n\t" /* восстановить регистр r1 (должен быть всегда 0) */ \
+                    : \
+                    : "r" ((uint16_t)(TaskContextPtr)) \
+                    : "r26", "r27", "r0" \
+                    )
+
 /**
 * Функция перехода на задачу (переключение задачи)
 * входной параметр:
@@ -46,7 +841,7 @@ static volatile uint32_t mRTOS_SystemTime; // счётчик времени ра
 */
 static void mRTOS_JmpTask(struct TaskContext* TaskContextPtr) __attribute__((noinline));
 static void mRTOS_JmpTask(struct TaskContext* TaskContextPtr) {
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    mRTOS_PORT_CRITICAL() {
         asm volatile(
                     "movw r26, %A0"                 "\n\t"  // сохранить адрес структуры контекста задачи в X
                     "ld   %A0, X+"                  "\n\t"  // прочитать мл. байт адреса точки входа в задачу
@@ -73,7 +868,7 @@ static void mRTOS_JmpTask(struct TaskContext* TaskContextPtr) {
 *                         будет сохранён контекст.
 */
 static inline void mRTOS_SaveContext(void (*Task)(void), struct TaskContext* TaskContextPtr) {
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    mRTOS_PORT_CRITICAL() {
         asm volatile(
                     "movw r26, %A1"                 "\n\t"  // сохранить адрес структуры контекста задачи в X
                     "st   X+, %A0"                  "\n\t"  // сохранить мл. байт адреса точки входа в задачу в структуре контекста задачи
@@ -87,6 +882,7 @@ static inline void mRTOS_SaveContext(void (*Task)(void), struct TaskContext* Tas
                     );
     }
 }
+#endif
 
 /**
 * Функция перевода текущей задачи в состояние Wait на определённое
@@ -99,25 +895,100 @@ static inline void mRTOS_SaveContext(void (*Task)(void), struct TaskContext* Tas
 */
 void mRTOS_WaitTask(uint16_t Delay, struct TaskContext* TaskContextPtr) __attribute__((noinline));
 void mRTOS_WaitTask(uint16_t Delay, struct TaskContext* TaskContextPtr) {
-    mRTOS_Tasks[mRTOS_CurrentTask].State = WAIT; // установить состояние текущей задачи в Wait
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
-        mRTOS_Tasks[mRTOS_CurrentTask].Delay = Delay; // установить время состояния Wait текущей задачи
-        asm volatile(
-                    "movw r26, %A0"                 "\n\t" // сохранить адрес структуры контекста задачи в X
-                    "pop  __tmp_reg__"              "\n\t" // прочитать ст. байт адреса возврата из стека
-                    "pop  __zero_reg__"             "\n\t" // прочитать мл. байт адреса возврата из стека
-                    "st   X+, __zero_reg__"         "\n\t" // сохранить мл. байт адреса возврата в структуре контекста задачи
-                    "st   X+, __tmp_reg__"          "\n\t" // сохранить ст. байт адреса возврата в структуре контекста задачи
-                    "in   __tmp_reg__, __SREG__"    "\n\t" // прочитать регистр SREG
-                    "st   X, __tmp_reg__"           "\n\t" // сохранить регистр SREG в структуре контекста задачи
-                    "clr  __zero_reg__"             "\n\t" // восстановить регистр r1 (должен быть всегда 0)
-                    :
-                    : "r" ((uint16_t)TaskContextPtr)
-                    : "r26", "r27", "r0"
-                    );
+    mRTOS_PORT_CRITICAL() {
+        mRTOS_SAVE_RETURN_CONTEXT(TaskContextPtr);    // сохранить контекст текущей задачи
+    }
+    mRTOS_WaitBlock(Delay);                    // перевести текущую задачу в состояние Wait и включить в список задержек
+    mRTOS_TRACE_REASON(mRTOS_TRACE_WAIT);
+    mRTOS_Scheduler();                         // вызвать функцию планировщика задач
+}
+
+/**
+* Функция перевода задачи в состояние Wait до заданного момента системного
+* времени (задержка не зависит от времени выполнения задачи до вызова,
+* поэтому период цикла задачи не накапливает ошибку)
+* входные параметры:
+* \param WakeTime - момент пробуждения в тиках системного времени (не далее
+*                   65535 тиков; сравнение учитывает переполнение счётчика);
+* \param TaskContextPtr - указатель на структуру контекста текущей задачи.
+*/
+void mRTOS_WaitUntil(uint32_t WakeTime, struct TaskContext* TaskContextPtr) __attribute__((noinline));
+void mRTOS_WaitUntil(uint32_t WakeTime, struct TaskContext* TaskContextPtr) {
+    mRTOS_PORT_CRITICAL() {
+        mRTOS_SAVE_RETURN_CONTEXT(TaskContextPtr);    // сохранить контекст текущей задачи
+    }
+    mRTOS_WaitBlockUntil(WakeTime);            // перевести текущую задачу в состояние Wait до момента WakeTime
+    mRTOS_TRACE_REASON(mRTOS_TRACE_WAIT);
+    mRTOS_Scheduler();                         // вызвать функцию планировщика задач
+}
+
+#if mRTOS_USE_PERIODIC_TASKS
+/**
+* Функция ожидания следующего выпуска текущей периодической задачи
+* (вызывается в конце цикла задачи вместо mRTOS_TASK_WAIT)
+* входной параметр:
+* \param TaskContextPtr - указатель на структуру контекста текущей задачи
+*/
+void mRTOS_WaitPeriod(struct TaskContext* TaskContextPtr) __attribute__((noinline));
+void mRTOS_WaitPeriod(struct TaskContext* TaskContextPtr) {
+    mRTOS_PORT_CRITICAL() {
+        mRTOS_SAVE_RETURN_CONTEXT(TaskContextPtr);    // сохранить контекст текущей задачи
     }
+    mRTOS_WaitBlockUntil(mRTOS_NextRelease(mRTOS_CurrentTask)); // ожидать момента следующего выпуска
+    mRTOS_TRACE_REASON(mRTOS_TRACE_WAIT);
     mRTOS_Scheduler();                         // вызвать функцию планировщика задач
 }
+#endif
+
+/**
+* Функция перевода текущей задачи в состояние Semaphore до установки события
+* с включением в список задержек (если задан тайм-аут) в одной критической
+* секции; если событие произошло после сохранения контекста задачи, то
+* задача сразу пробуждается
+* входные параметры:
+* \param EventNumber - номер события;
+* \param Timeout - тайм-аут в тиках (0 - без тайм-аута).
+*/
+static void mRTOS_EventBlock(uint8_t EventNumber, uint16_t Timeout) __attribute__((noinline));
+static void mRTOS_EventBlock(uint8_t EventNumber, uint16_t Timeout) {
+    mRTOS_PORT_CRITICAL() {
+        if(mRTOS_Events[EventNumber].FlagEvent)   // если событие произошло, то
+            mRTOS_WakeTask(mRTOS_CurrentTask);    // продолжить выполнение текущей задачи
+        else {
+            mRTOS_TASK_STATE(mRTOS_CurrentTask) = SEMAPHORE; // установить состояние текущей задачи в Semaphore
+            mRTOS_WaitObject[mRTOS_CurrentTask] = &mRTOS_Events[EventNumber]; // запомнить ожидаемое событие
+#if mRTOS_USE_BITMAP_SCHEDULER
+            mRTOS_ReadyRemove(mRTOS_CurrentTask); // исключить текущую задачу из битовых карт готовности
+#endif
+            mRTOS_DelayInsert(mRTOS_CurrentTask, Timeout); // включить текущую задачу в список задержек (если задан тайм-аут)
+        }
+    }
+}
+
+/**
+* Функция ожидания события: текущая задача переводится в состояние
+* Semaphore до установки события или до истечения тайм-аута. Событие
+* должно быть закреплено за текущей задачей функцией mRTOS_InitEvent.
+* После возврата в задачу результат проверяется функцией mRTOS_GetEvent
+* (0 - истёк тайм-аут).
+* входные параметры:
+* \param EventNumber - номер события;
+* \param Timeout - тайм-аут в тиках (0 - без тайм-аута);
+* \param TaskContextPtr - указатель на структуру контекста текущей задачи.
+*/
+void mRTOS_WaitEvent(uint8_t EventNumber, uint16_t Timeout, struct TaskContext* TaskContextPtr) __attribute__((noinline));
+void mRTOS_WaitEvent(uint8_t EventNumber, uint16_t Timeout, struct TaskContext* TaskContextPtr) {
+    if(EventNumber >= mRTOS_MAX_EVENTS)       // если номер события не верный, то
+        return;                               // выход без ожидания
+    mRTOS_PORT_CRITICAL() {
+        if(mRTOS_Events[EventNumber].FlagEvent) // если событие уже произошло, то
+            return;                           // выход без ожидания
+        mRTOS_SAVE_RETURN_CONTEXT(TaskContextPtr); // сохранить контекст текущей задачи
+    }
+    mRTOS_EventBlock(EventNumber, Timeout);   // перевести текущую задачу в ожидание события
+    mRTOS_TRACE_REASON(mRTOS_TRACE_EVENT);
+    mRTOS_Scheduler();                        // вызвать функцию планировщика задач
+}
 
 /**
 * Функция диспетчера задач
@@ -126,46 +997,297 @@ void mRTOS_WaitTask(uint16_t Delay, struct TaskContext* TaskContextPtr) {
 */
 void mRTOS_DispatchTask(struct TaskContext* TaskContextPtr) __attribute__((noinline));
 void mRTOS_DispatchTask(struct TaskContext* TaskContextPtr) {
-    mRTOS_Tasks[mRTOS_CurrentTask].State = ACTIVE; // состояние текущей задачи установить в Active
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
-        asm volatile(
-                    "movw r26, %A0"                 "\n\t" // сохранить адрес структуры контекста задачи в X
-                    "pop %B0"                       "\n\t" // прочитать ст. байт адреса возврата из стека
-                    "pop %A0"                       "\n\t" // прочитать мл. байт адреса возврата из стека
-                    "st  X+, %A0"                   "\n\t" // сохранить мл. байт адреса возврата в структуре контекста задачи
-                    "st  X+, %B0"                   "\n\t" // сохранить ст. байт адреса возврата в структуре контекста задачи
-                    "in   __tmp_reg__, __SREG__"    "\n\t" // прочитать регистр SREG
-                    "st   X, __tmp_reg__"           "\n\t" // сохранить регистр SREG в структуре контекста задачи
-                    : "+r" ((uint16_t)TaskContextPtr)
-                    :
-                    : "r26", "r27", "r0"
-                    );
+    mRTOS_PORT_CRITICAL() {
+        mRTOS_TASK_STATE(mRTOS_CurrentTask) = ACTIVE; // состояние текущей задачи установить в Active
+#if mRTOS_USE_BITMAP_SCHEDULER
+        mRTOS_ReadyInsert(mRTOS_CurrentTask);          // включить текущую задачу в битовые карты готовности
+#endif
+        mRTOS_SAVE_RETURN_CONTEXT(TaskContextPtr);     // сохранить контекст текущей задачи
     }
+    mRTOS_TRACE_REASON(mRTOS_TRACE_DISPATCH);
     mRTOS_Scheduler(); // вызвать функцию планировщика задач
 }
 
+/**
+*  Функция нулевой задачи (процесс по умолчанию)
+*/
+#if mRTOS_USE_TICKLESS_IDLE
+/**
+* Функция проверки, что кроме задачи Idle нет готовых к выполнению задач
+* (вызывается при запрещённых прерываниях)
+* возвращает:
+* \return 1 - готова только задача Idle
+* \return 0 - есть другие готовые задачи
+*/
+static uint8_t mRTOS_IdleOnly(void) {
+#if mRTOS_USE_BITMAP_SCHEDULER
+    uint8_t level = mRTOS_PRIORITY_LEVEL(mRTOS_TASK_PRIORITY(0));
+    return (mRTOS_ExpiredMask == 0) &&
+           (mRTOS_ReadyGroup == mRTOS_LEVEL_BIT(level)) &&
+           (mRTOS_ReadyTable[level] == mRTOS_TASK_BIT(0));
+#else
+    uint8_t i;
+    for(i=1; i < mRTOS_InitTasksCounter; i++)                      // цикл сканирования задач приложения
+        if((mRTOS_TASK_STATE(i) == ACTIVE) || mRTOS_TASK_EXPIRED(i)) // если задача в состоянии Active или её задержка истекла, то
+            return 0;
+    return 1;
+#endif
+}
+
+/**
+* Функция перевода микроконтроллера в режим сна из задачи Idle
+* Если готова только задача Idle, системный таймер перепрограммируется на
+* интервал до ближайшего пробуждения задачи (но не более
+* mRTOS_TICKLESS_MAX_TICKS тиков), иначе сон длится до следующего прерывания.
+*/
+static void mRTOS_IdleSleep(void) {
+    uint16_t ticks;
+#if mRTOS_SYSTEM_TIMER != 1
+    uint16_t counts;
+#endif
+    cli();
+#if mRTOS_USE_JOBS
+    if(!mRTOS_IdleOnly() || mRTOS_JobPending) {           // если есть готовые задачи или запрошенные задачи-jobs, то
+#else
+    if(!mRTOS_IdleOnly()) {                               // если есть готовые задачи, то
+#endif
+        sei();
+        return;                                           // не засыпать
+    }
+    ticks = mRTOS_TICKLESS_MAX_TICKS;
+    if((mRTOS_DelayHead != mRTOS_NO_TASK) && (mRTOS_DelayDelta[mRTOS_DelayHead] < ticks)) // интервал до ближайшего пробуждения задачи
+        ticks = mRTOS_DelayDelta[mRTOS_DelayHead];
+#if mRTOS_USE_TIMERS
+    if(mRTOS_TimerDelay() < ticks)                        // интервал до срабатывания первого программного таймера
+        ticks = mRTOS_TimerDelay();
+#endif
+#if mRTOS_USE_JOBS
+    if(mRTOS_JobDelay() < ticks)                          // интервал до ближайшего выполнения периодической задачи-job
+        ticks = mRTOS_JobDelay();
+#endif
+    if(ticks > 1) {                                       // если сон длиннее тика, то
+#if mRTOS_SYSTEM_TIMER == 1
+        if(!mRTOS_TicklessLength && !(TIFR & _BV(OCF1A))) { // если период T1 - один тик и тик не ожидает обработки, то
+            OCR1A = ticks * mRTOS_TICK_COUNTS - 1;        // продлить период T1 до ближайшего пробуждения
+            mRTOS_TicklessLength = ticks;
+            if(TIFR & _BV(OCF1A)) {                       // если тик истёк во время записи OCR1A, то
+                OCR1A = mRTOS_TICK_COUNTS - 1;            // продолжить обычный тик
+                mRTOS_TicklessLength = 0;
+            }
+        }
+#else
+        TCCR0 = 0;                                        // остановить системный таймер
+        if(TIFR & _BV(TOV0)) {                            // если переполнение T0 ожидает обработки, то
+            TCCR0 = mRTOS_SYSTEM_TIMER_PRESCALER_VALUE;   // продолжить обычный тик
+        } else {
+            mRTOS_TicklessStart = TCNT0 - mRTOS_SYSTEM_TIMER_RELOAD_VALUE; // отсчёты, прошедшие в текущем тике
+            counts = ticks * mRTOS_TICK_COUNTS - mRTOS_TicklessStart;     // интервал сна в отсчётах основного предделителя
+            mRTOS_TicklessLength = counts / mRTOS_TICKLESS_TIMER_PRESCALER_RATIO; // интервал сна в отсчётах предделителя сна (остаток дорабатывается обычным тиком)
+            TCNT0 = -mRTOS_TicklessLength;
+            SFIOR |= _BV(PSR10);                          // сбросить предделитель T0 (и T1)
+            TCCR0 = mRTOS_TICKLESS_TIMER_PRESCALER_VALUE; // запустить системный таймер с предделителем сна
+        }
+#endif
+    }
+    set_sleep_mode(mRTOS_IDLE_SLEEP_MODE);
+    sleep_enable();
+    sei();                                                // команда после sei выполняется до обработки прерываний,
+    sleep_cpu();                                          // поэтому прерывание не может быть потеряно перед сном
+    sleep_disable();
+    cli();
+    if(mRTOS_TicklessLength)                              // если пробуждение произошло до окончания интервала сна, то
+        mRTOS_TicklessStop(mRTOS_TicklessElapsed());      // завершить сон с учётом прошедшего времени
+    sei();
+}
+#endif
+
 /**
 *  Функция нулевой задачи (процесс по умолчанию)
 */
 static void mRTOS_Idle(void) {
     mRTOS_SetTaskNStatus(0, ACTIVE);      // вызвать функцию установки состояния 0-й задачи - Active
     while(1) {                            // цикл работы задачи Idle
+#if mRTOS_USE_TICKLESS_IDLE
+        mRTOS_IdleSleep();                // перейти в режим сна, если других готовых задач нет
+#endif
+        mRTOS_PortIdle();                 // действие порта (Linux - тик виртуальных часов)
         mRTOS_DISPATCH;                   // вызвать планировщик задач
     }
 }
 
+#if mRTOS_USE_JOBS
 /**
-* Обработчик прерывания по переполнению таймера T0
-* (таймер системного времени mRTOS)
+* Функция выполнения одной задачи-job: выбирается запрошенная задача-job с
+* наибольшим приоритетом, не ниже приоритета выбранной обычной задачи
+* (вызывается планировщиком; выделена в отдельную функцию, поэтому её
+* локальные переменные не используют стек планировщика)
+* возвращает:
+* \return 1 - задача-job выполнена
+* \return 0 - нет задач-jobs для выполнения
 */
-ISR(TIMER0_OVF_vect) {
-    uint8_t i;
-    TCNT0 = mRTOS_SYSTEM_TIMER_RELOAD_VALUE;  // инициализация значения таймера для обеспечения заданного времени системного тика
+static uint8_t mRTOS_RunJob(void) __attribute__((noinline));
+static uint8_t mRTOS_RunJob(void) {
+    uint8_t i, job = mRTOS_NO_TASK, pri;
+    pri = mRTOS_CurrentTask ? mRTOS_TASK_PRIORITY(mRTOS_CurrentTask) : 0; // при выбранной задаче Idle - любые задачи-jobs
+    mRTOS_PORT_CRITICAL() {
+        for(i = 0; i < mRTOS_InitJobsCounter; i++)    // цикл поиска запрошенной задачи-job с наибольшим приоритетом
+            if((mRTOS_JobPending & (1 << i)) && (mRTOS_JobPriority[i] >= pri)) {
+                pri = mRTOS_JobPriority[i];
+                job = i;
+            }
+        if(job != mRTOS_NO_TASK)
+            mRTOS_JobPending &= ~(1 << job);          // снять запрос выбранной задачи-job
+    }
+    if(job == mRTOS_NO_TASK)
+        return 0;
+    mRTOS_JobFunction[job]();                         // выполнить задачу-job до завершения
+    return 1;
+}
+#endif
+
+#if mRTOS_USE_TASK_BUDGET
+/**
+* Функция отсчёта длительности выполнения текущей задачи: обновляется
+* наибольшая длительность, при превышении бюджета выполняется
+* mRTOS_TASK_OVERRUN (вызывается из системного тика)
+*/
+static inline void mRTOS_BudgetTick(void) {
+    uint8_t task = mRTOS_CurrentTask;
+    if(mRTOS_RunTicks != 0xFFFF)              // если длительность не достигла предела, то
+        mRTOS_RunTicks++;                     // отсчитать тик
+    if(mRTOS_RunTicks > mRTOS_TaskRunMax[task])
+        mRTOS_TaskRunMax[task] = mRTOS_RunTicks; // обновить наибольшую длительность выполнения
+    if(mRTOS_TaskBudget[task] && (mRTOS_RunTicks == mRTOS_TaskBudget[task] + 1)) { // если бюджет задачи превышен, то
+        if(mRTOS_TaskOverruns[task] != 255)
+            mRTOS_TaskOverruns[task]++;       // отметить превышение (однократно за выполнение)
+        mRTOS_TASK_OVERRUN(task);             // и выполнить действие при превышении
+    }
+}
+#endif
+
+/**
+* Функция обработки системного тика (вызывается из обработчика прерывания
+* таймера системного тика)
+*/
+static inline void mRTOS_SystemTick(void) {
+#if mRTOS_USE_TICKLESS_IDLE
+    if(mRTOS_TicklessLength) {                // если истёк интервал сна задачи Idle, то
+        mRTOS_TicklessStop(mRTOS_TICKLESS_FULL); // завершить сон
+        return;
+    }
+#endif
+    mRTOS_PortTickReload();                   // перезагрузка таймера системного тика
+#if mRTOS_USE_STACK_MONITOR && !mRTOS_USE_PREEMPTIVE
+    mRTOS_STACK_SAMPLE(mRTOS_StackIsrMin, SP); // отметить глубину стека в обработчике
+    if(mRTOS_FlagStart)                       // если mRTOS запущена, то
+        mRTOS_STACK_SAMPLE(mRTOS_StackTaskMin[mRTOS_CurrentTask], SP); // отметить глубину стека прерванной задачи
+#endif
+#if mRTOS_USE_TASK_BUDGET
+    if(mRTOS_FlagStart)                       // если mRTOS запущена, то
+        mRTOS_BudgetTick();                   // отсчитать длительность выполнения текущей задачи
+#endif
     mRTOS_SystemTime++;                       // инкремент счётчика системного времени
-    for(i=0; i < mRTOS_InitTasksCounter; i++) // цикл сканирования инициализированных задач
-        if(mRTOS_Tasks[i].Delay)              // если интервал времени задержки задачи не истёк, то
-            --mRTOS_Tasks[i].Delay;           // декремент счётчика времени задержки задачи
+#if mRTOS_USE_TIME64
+    if(!mRTOS_SystemTime)                     // если счётчик тиков переполнился, то
+        mRTOS_SystemTimeHigh++;               // увеличить старшую часть времени
+#endif
+    mRTOS_TimeSequence++;                     // системное время изменено
+    mRTOS_DelayTick(1);                       // отсчёт тика в списке задержек
+#if mRTOS_USE_TIMERS
+    mRTOS_TimerTick(1);                       // отсчёт тика программных таймеров
+#endif
+#if mRTOS_USE_JOBS
+    mRTOS_JobTick(1);                         // отсчёт тика периодических задач-jobs
+#endif
+}
+
+#if mRTOS_USE_PREEMPTIVE
+static void mRTOS_SwitchContext(void);
+
+/**
+* Функция системного тика вытесняющего режима: если в тике пробуждена задача
+* (или истёк квант времени), то вызывается планировщик задач
+*/
+static void mRTOS_PreemptiveTick(void) __attribute__((noinline));
+static void mRTOS_PreemptiveTick(void) {
+    mRTOS_SystemTick();                       // обработать системный тик
+    if(!mRTOS_FlagStart)                      // если mRTOS не запущена, то
+        return;                               // вернуться в функцию main
+#if mRTOS_TIME_SLICE
+    if(++mRTOS_SliceCounter >= mRTOS_TIME_SLICE) // если квант времени текущей задачи истёк, то
+        mRTOS_FlagWake = 1;                   // запросить вытеснение
+#endif
+    if(mRTOS_FlagWake) {                      // если запрошено вытеснение, то
+        mRTOS_TRACE_REASON(mRTOS_TRACE_PREEMPT);
+        mRTOS_SwitchContext();                // выбрать задачу для выполнения
+    }
+}
+
+/**
+* Обработчик прерывания таймера системного тика
+* (вытесняющий режим)
+*/
+ISR(mRTOS_TIMER_vect, ISR_NAKED) {
+    mRTOS_SAVE_CONTEXT();                     // сохранить контекст прерванной задачи
+    // SREG прочитан уже при запрещённых аппаратно прерываниях, а задача была прервана при разрешённых,
+    // поэтому в сохранённом SREG устанавливается флаг I: иначе при возврате в задачу через ret
+    // (из планировщика, а не из обработчика) она продолжила бы выполнение с запрещёнными прерываниями
+    // (7 тактов; SREG в стеке - по адресу SP + 32)
+    asm volatile(
+                "in   r28, __SP_L__"          "\n\t"
+                "in   r29, __SP_H__"          "\n\t"
+                "ldd  r16, Y+32"              "\n\t"
+                "ori  r16, 0x80"              "\n\t"
+                "std  Y+32, r16"              "\n\t"
+                );
+    mRTOS_PreemptiveTick();                   // обработать системный тик
+    mRTOS_RESTORE_CONTEXT();                  // восстановить контекст текущей (возможно другой) задачи
+    reti();
+}
+#else
+/**
+* Обработчик прерывания таймера системного тика
+* (переполнение T0 или совпадение T1, T2 в режиме CTC)
+*/
+mRTOS_PORT_TICK_ISR() {
+    mRTOS_SystemTick();                       // обработать системный тик
 }
+#endif
+
+#if mRTOS_USE_STATIC_TASKS
+// --- статическая таблица задач и событий (flash) ---
+struct TaskDescriptor {
+    void (*Task)(void);          // указатель на функцию задачи
+    uint8_t Priority,            // исходный приоритет задачи
+    State;                       // начальное состояние задачи
+};
+#define mRTOS_TASK_PROTOTYPE(Task, Priority, State) void Task(void);
+#define mRTOS_TASK_CHECK(Task, Priority, State) \
+        typedef char mRTOS_TaskCheck_##Task[(((Priority) >= 1) && ((Priority) <= 255) && ((State) != NOINIT)) ? 1 : -1];
+#define mRTOS_TASK_DESCRIPTOR(Task, Priority, State) {Task, Priority, State},
+#define mRTOS_EVENT_DESCRIPTOR(Event, Task) mRTOS_TASK_ID(Task),
+
+mRTOS_TASK_TABLE(mRTOS_TASK_PROTOTYPE)   // прототипы функций задач
+mRTOS_TASK_TABLE(mRTOS_TASK_CHECK)       // проверка приоритетов и состояний задач на этапе компиляции
+typedef char mRTOS_EventCountCheck[(mRTOS_MAX_EVENTS == mRTOS_EVENT_ID_END) ? 1 : -1];
+
+static const struct TaskDescriptor mRTOS_TaskTable[mRTOS_MAX_TASKS] PROGMEM = { // таблица задач (задача Idle - первая)
+    {mRTOS_Idle, 5, ACTIVE},
+    mRTOS_TASK_TABLE(mRTOS_TASK_DESCRIPTOR)
+};
+static const uint8_t mRTOS_EventTaskTable[mRTOS_MAX_EVENTS] PROGMEM = {        // номера задач, за которыми закреплены события
+    mRTOS_EVENT_TABLE(mRTOS_EVENT_DESCRIPTOR)
+};
+#define mRTOS_EVENT_TASK(EventNumber) pgm_read_byte(&mRTOS_EventTaskTable[EventNumber])
+#else
+#define mRTOS_EVENT_TASK(EventNumber) mRTOS_Events[EventNumber].TaskNumber
+#endif
+
+#if mRTOS_USE_FAST_EVENTS
+// регистры быстрых событий должны быть доступны командам sbi/cbi/sbis (адреса ввода-вывода 0x00...0x1F)
+typedef char mRTOS_FastEventRegCheck[((_SFR_IO_ADDR(mRTOS_FAST_EVENT_REG) < 0x20) &&
+                                      (_SFR_IO_ADDR(mRTOS_FAST_EVENT_ENABLE_REG) < 0x20)) ? 1 : -1];
+#endif
 
 /**
 * Функция инициализации mRTOS
@@ -173,23 +1295,84 @@ ISR(TIMER0_OVF_vect) {
 void mRTOS_Init(void) {
     uint8_t i;
     for(i=0; i < mRTOS_MAX_TASKS; i++) {         // цикл инициализации массива структур задач
-        mRTOS_Tasks[i].Priority = 0;             // обнулить приоритет задачи
-        mRTOS_Tasks[i].CurrentPriority = 0;      // обнулить текущий приоритет задачи
-        mRTOS_Tasks[i].State = NOINIT;           // установить состояние задачи - NoInit
+        mRTOS_TASK_PRIORITY(i) = 0;              // обнулить приоритет задачи
+        mRTOS_TASK_CREDIT(i) = 0;                // обнулить текущий приоритет задачи
+        mRTOS_TASK_STATE(i) = NOINIT;            // установить состояние задачи - NoInit
+#if !mRTOS_USE_PACKED_TCB
         mRTOS_Tasks[i].Delay = 0;                // обнулить поле задержки
+#endif
+        mRTOS_DelayPrev[i] = mRTOS_NOT_LINKED;   // задача не включена в список задержек
+        mRTOS_MutexHeld[i] = 0;                  // задача не владеет мьютексом
+#if mRTOS_USE_PERIODIC_TASKS
+        mRTOS_TaskPeriod[i] = 0;                 // задача не периодическая
+        mRTOS_TaskMissed[i] = 0;                 // обнулить счётчик пропущенных выпусков
+#endif
+#if mRTOS_USE_TASK_BUDGET
+        mRTOS_TaskBudget[i] = 0;                 // бюджет задачи не задан
+        mRTOS_TaskRunMax[i] = 0;                 // обнулить наибольшую длительность выполнения
+        mRTOS_TaskOverruns[i] = 0;               // обнулить счётчик превышений бюджета
+#endif
+#if mRTOS_USE_EVENT_GROUPS
+        mRTOS_WaitMode[i] = 0;                   // задача не ожидает флаги группы событий
+#endif
     }
     for(i=0; i < mRTOS_MAX_EVENTS; i++) {        // цикл инициализации массива структур событий
+#if mRTOS_USE_STATIC_TASKS
+        mRTOS_Events[i].FlagControlEvent = 1;    // событие статической таблицы разрешено сразу
+#else
         mRTOS_Events[i].TaskNumber = 0;          // обнулить номер закреплённой за событием задачи
         mRTOS_Events[i].FlagControlEvent = 0;    // сбросить флаг разрешения события
+#endif
         mRTOS_Events[i].FlagEvent = 0;           // обнулить флаг события
     }
+#if mRTOS_USE_FAST_EVENTS
+    mRTOS_FAST_EVENT_REG = 0;                    // сбросить быстрые события
+    mRTOS_FAST_EVENT_ENABLE_REG |= ((1 << mRTOS_FAST_EVENTS) - 1) << mRTOS_FAST_EVENT_ENABLE_SHIFT; // и разрешить их
+#endif
+#if mRTOS_USE_BITMAP_SCHEDULER
+    for(i=0; i < mRTOS_PRIORITY_LEVELS; i++) {   // цикл инициализации битовых карт готовности
+        mRTOS_ReadyTable[i] = 0;
+        mRTOS_ServedTable[i] = 0;
+    }
+    mRTOS_ReadyGroup = 0;
+    mRTOS_ExpiredMask = 0;
+#endif
+    mRTOS_DelayHead = mRTOS_NO_TASK;             // очистить список задержек
     mRTOS_InitTasksCounter = 0;                  // обнулить счётчик количества инициализированных задач в приложении
+#if mRTOS_USE_JOBS
+    mRTOS_InitJobsCounter = 0;                   // обнулить счётчик задач-jobs
+    mRTOS_JobPending = 0;
+#endif
     mRTOS_FlagStart = 0;                         // сбросить флаг признака запуска mRTOS
+#if mRTOS_USE_PREEMPTIVE
+    mRTOS_CurrentContext = &mRTOS_StartContext;  // до запуска mRTOS прерывание системного тика возвращается в функцию main
+    mRTOS_FlagWake = 0;                          // сбросить запрос вытеснения
+#endif
+#if mRTOS_USE_STACK_SAVE
+    mRTOS_StackBase = 0;                         // база задач определяется при запуске mRTOS
+#endif
+#if mRTOS_USE_STACK_MONITOR
+#if !mRTOS_USE_PREEMPTIVE
+    for(i=0; i < mRTOS_MAX_TASKS; i++)           // сбросить отметки глубины стека задач
+        mRTOS_StackTaskMin[i] = RAMEND;
+    mRTOS_StackIsrMin = RAMEND;
+#endif
+    mRTOS_StackPaint();                          // окрасить свободную область стека
+#endif
     mRTOS_CurrentTask = 0;                       // установить номер текущей задачи - 0
     mRTOS_SystemTime = 0;                        // сбросить счётчик системного времени
+#if mRTOS_USE_TIME64
+    mRTOS_SystemTimeHigh = 0;
+#endif
+#if mRTOS_USE_STATIC_TASKS
+    for(i=0; i < mRTOS_MAX_TASKS; i++)           // цикл создания задач статической таблицы (задача Idle - первая)
+        mRTOS_CreateTask((void (*)(void))pgm_read_word(&mRTOS_TaskTable[i].Task),
+                         pgm_read_byte(&mRTOS_TaskTable[i].Priority),
+                         pgm_read_byte(&mRTOS_TaskTable[i].State));
+#else
     mRTOS_CreateTask(mRTOS_Idle, 5, ACTIVE);     // вызвать функцию создания фоновой задачи Idle с приоритетом 5 с состоянием Active
-    TCNT0 = mRTOS_SYSTEM_TIMER_RELOAD_VALUE;     // инициализация системного таймера (T0)
-    TCCR0 = mRTOS_SYSTEM_TIMER_PRESCALER_VALUE;  // запуск системного таймера
+#endif
+    mRTOS_PortTickStart();                       // запуск таймера системного тика
 }
 
 /**
@@ -206,33 +1389,151 @@ uint8_t mRTOS_CreateTask(void (*Task)(void), uint8_t Priority, enum TaskState St
     if((mRTOS_InitTasksCounter >= mRTOS_MAX_TASKS) || // если счётчик количества инициализированных задач достиг максимума
        (Priority == 0))                               // или приоритет не верный, то
         return 0;                                     // выход с кодом ошибки
-    mRTOS_SaveContext(Task, &mRTOS_Tasks[mRTOS_InitTasksCounter].Context); // вызвать функцию сохранения контекста задачи
-    mRTOS_Tasks[mRTOS_InitTasksCounter].Priority = Priority;               // установить приоритет задачи
-    mRTOS_Tasks[mRTOS_InitTasksCounter].CurrentPriority = Priority;        // установить текущий приоритет задачи
-    mRTOS_Tasks[mRTOS_InitTasksCounter++].State = State;                   // установить состояние задачи и инкремент счётчика инициализированных задач
+#if mRTOS_USE_PREEMPTIVE
+    mRTOS_InitStack(Task, mRTOS_InitTasksCounter);                         // вызвать функцию подготовки стека задачи
+#elif mRTOS_USE_STACK_SAVE
+    mRTOS_InitStackSave(Task, mRTOS_InitTasksCounter);                     // вызвать функцию подготовки сегмента стека задачи
+#elif mRTOS_PORT_HOST
+    mRTOS_PortInitTask(Task, mRTOS_InitTasksCounter);                      // вызвать функцию подготовки контекста задачи порта
+#else
+    mRTOS_SaveContext(Task, &mRTOS_TASK_CONTEXT(mRTOS_InitTasksCounter)); // вызвать функцию сохранения контекста задачи
+#endif
+    mRTOS_TASK_PRIORITY(mRTOS_InitTasksCounter) = Priority;                // установить приоритет задачи
+    mRTOS_TASK_CREDIT(mRTOS_InitTasksCounter) = Priority;                  // установить текущий приоритет задачи
+    mRTOS_TASK_STATE(mRTOS_InitTasksCounter) = State;                      // установить состояние задачи
+#if mRTOS_USE_BITMAP_SCHEDULER
+    mRTOS_PORT_CRITICAL() {
+        mRTOS_ReadyUpdate(mRTOS_InitTasksCounter);                         // отметить задачу в битовых картах готовности
+    }
+#endif
+    mRTOS_InitTasksCounter++;                                              // инкремент счётчика инициализированных задач
     return 1;                                         // выход с кодом успешного выполнения
 }
 
+#if mRTOS_USE_PACKED_TCB && !mRTOS_USE_BITMAP_SCHEDULER && (mRTOS_SCHEDULING_POLICY == mRTOS_POLICY_CREDIT)
 /**
-*  Функция планировщика задач
+* Функция выбора задачи последовательным перебором упакованных массивов
+* состояний и текущих приоритетов (кредитов) задач; выделена в отдельную
+* функцию, поэтому её локальные переменные не используют стек планировщика.
+* Массивы не volatile и изменяются в прерываниях (пробуждение задач), поэтому
+* перебор выполняется при запрещённых прерываниях: иначе обработчик мог бы
+* изменить состояние текущей задачи между её исключением из выбора и
+* восстановлением, а компилятор - использовать прочитанные ранее значения
+* возвращает:
+* \return номер выбранной задачи
 */
-void mRTOS_Scheduler(void) {
-    uint16_t temp;
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
-        asm volatile(
-                    "pop  __tmp_reg__"              "\n\t"  // очистить текущее состояние стека
-                    "pop  __tmp_reg__"              "\n\t"
-                    :
-                    :
-                    : "r0"
-                    );
+static uint8_t mRTOS_ScanTasks(void) __attribute__((noinline));
+static uint8_t mRTOS_ScanTasks(void) {
+    uint8_t* StatePtr;
+    uint8_t* CreditPtr;
+    const uint8_t* PriorityPtr;
+    uint8_t i, state, pri = 0, current = mRTOS_CurrentTask, task = current, active = 0;
+    mRTOS_PORT_CRITICAL() {
+        if(--mRTOS_TaskCredit[current] == 0) {         // декремент текущего приоритета текущей задачи и если он равен нулю, то
+            CreditPtr = mRTOS_TaskCredit;              // восстановить приоритет всех задач
+            PriorityPtr = mRTOS_TaskPriority;
+            for(i = mRTOS_InitTasksCounter; i; i--)
+                *CreditPtr++ = *PriorityPtr++;
+        }
+        if(mRTOS_TaskState[current] == ACTIVE) {       // если состояние текущей задачи Active, то
+            mRTOS_TaskState[current] = SUSPEND;        // исключить её из выбора на время сканирования
+            active = 1;
+        }
+        StatePtr = mRTOS_TaskState;
+        CreditPtr = mRTOS_TaskCredit;
+        for(i = 0; i < mRTOS_InitTasksCounter; i++) {  // цикл сканирования задач
+            state = *StatePtr++;
+            if(state == WAIT) {                        // если задержка задачи истекла, то
+                task = i;                              // передать управление этой задаче не зависимо от приоритета
+                break;
+            }
+            if((state == ACTIVE) && (*CreditPtr >= pri)) { // поиск задачи в состоянии Active с наиболее высоким приоритетом
+                pri = *CreditPtr;
+                task = i;
+            }
+            CreditPtr++;
+        }
+        if(active)                                     // вернуть текущей задаче состояние Active
+            mRTOS_TaskState[current] = ACTIVE;
+    }
+    return task;
+}
+#endif
+
+#if mRTOS_SCHEDULING_POLICY != mRTOS_POLICY_CREDIT
+/**
+* Функция выбора задачи по политике фиксированных приоритетов или наиболее
+* раннего срока: задачи сканируются по кругу, начиная со следующей за текущей,
+* поэтому среди задач с равным приоритетом (сроком) управление передаётся по
+* кругу; выделена в отдельную функцию, поэтому её локальные переменные не
+* используют стек планировщика
+* возвращает:
+* \return номер выбранной задачи (0 - задача Idle, если других готовых задач нет)
+*/
+static uint8_t mRTOS_PolicySelect(void) __attribute__((noinline));
+static uint8_t mRTOS_PolicySelect(void) {
+    uint8_t i, n = mRTOS_CurrentTask, task = 0, pri = 0;
+#if mRTOS_SCHEDULING_POLICY == mRTOS_POLICY_EDF
+    uint8_t FlagDeadline = 0;                               // у выбранной задачи есть срок
+    uint32_t deadline = 0, d;
+#endif
+    for(i = mRTOS_InitTasksCounter; i; i--) {               // цикл сканирования задач
+        if(++n >= mRTOS_InitTasksCounter)
+            n = 0;
+        if((n == 0) ||                                      // задача Idle выбирается, только если других готовых задач нет
+           !((mRTOS_TASK_STATE(n) == ACTIVE) || mRTOS_TASK_EXPIRED(n))) // задача не готова к выполнению
+            continue;
+#if mRTOS_SCHEDULING_POLICY == mRTOS_POLICY_EDF
+        if(mRTOS_TaskPeriod[n]) {                           // если у задачи есть срок (момент следующего выпуска), то
+            d = mRTOS_TaskRelease[n] + mRTOS_TaskPeriod[n];
+            if(!FlagDeadline || mRTOS_TIME_BEFORE(d, deadline)) { // выбрать задачу с наиболее ранним сроком
+                FlagDeadline = 1;
+                deadline = d;
+                task = n;
+            }
+            continue;
+        }
+        if(FlagDeadline)                                    // задачи без срока - после задач со сроком
+            continue;
+#endif
+        if(mRTOS_TASK_PRIORITY(n) > pri) {                  // выбрать задачу с наибольшим приоритетом
+            pri = mRTOS_TASK_PRIORITY(n);
+            task = n;
+        }
+    }
+    return task;
+}
+#endif
+
+/**
+*  Функция выбора задачи для выполнения (номер выбранной задачи
+*  записывается в mRTOS_CurrentTask)
+*/
+static inline void mRTOS_SelectTask(void) __attribute__((always_inline));
+static inline void mRTOS_SelectTask(void) {
+#if mRTOS_SCHEDULING_POLICY != mRTOS_POLICY_CREDIT
+    mRTOS_CurrentTask = mRTOS_PolicySelect();                   // выбрать задачу по заданной политике
+#elif mRTOS_USE_BITMAP_SCHEDULER
+    mRTOS_PORT_CRITICAL() {
+        if(mRTOS_ExpiredMask) {                                  // если есть задачи с истёкшей задержкой, то
+            mRTOS_CurrentTask = mRTOS_FindFirstTask(mRTOS_ExpiredMask); // передать управление первой из них не зависимо от приоритета
+            mRTOS_ExpiredMask &= ~mRTOS_TASK_BIT(mRTOS_CurrentTask);
+        } else {
+            mRTOS_Scheduler_i = pgm_read_byte(&mRTOS_UnmapTable[mRTOS_ReadyGroup]); // найти старший уровень приоритета с готовыми задачами
+            mRTOS_Scheduler_mask = mRTOS_ReadyTable[mRTOS_Scheduler_i] & ~mRTOS_ServedTable[mRTOS_Scheduler_i]; // готовые задачи уровня, не получавшие управление в текущем круге
+            if(!mRTOS_Scheduler_mask) {                          // если круг завершён, то
+                mRTOS_ServedTable[mRTOS_Scheduler_i] = 0;        // начать новый круг
+                mRTOS_Scheduler_mask = mRTOS_ReadyTable[mRTOS_Scheduler_i];
+            }
+            mRTOS_CurrentTask = mRTOS_FindFirstTask(mRTOS_Scheduler_mask);            // выбрать первую задачу круга
+            mRTOS_ServedTable[mRTOS_Scheduler_i] |= mRTOS_TASK_BIT(mRTOS_CurrentTask); // отметить её как получившую управление
+        }
     }
+#elif mRTOS_USE_PACKED_TCB
+    mRTOS_CurrentTask = mRTOS_ScanTasks();                      // выбрать задачу перебором упакованных массивов
+#else
     mRTOS_Scheduler_pri = 0;
     mRTOS_FlagSchedulerActive = 0;
-    if(!mRTOS_FlagStart) {                                      // если первый вход в планировщик (при запуске mRTOS), то
-        mRTOS_FlagStart = 1;                                    // взвести флаг признака запуска mRTOS
-        mRTOS_JmpTask(&mRTOS_Tasks[mRTOS_CurrentTask].Context); // вызывать функцию передачи управление первой задаче
-    }
     if(--mRTOS_Tasks[mRTOS_CurrentTask].CurrentPriority == 0)   // декремент текущего приоритета текущей задачи и если он равен нулю хотя бы для одной задачи, то восстановить приоритет всех задач
         for(mRTOS_Scheduler_i=0;                                // цикл восстановления приоритета всех задач
             mRTOS_Scheduler_i < mRTOS_InitTasksCounter;
@@ -244,10 +1545,9 @@ void mRTOS_Scheduler(void) {
         mRTOS_FlagSchedulerActive = 1;                   // взвести флаг активности
     }
     for(mRTOS_Scheduler_i=0; mRTOS_Scheduler_i < mRTOS_InitTasksCounter; mRTOS_Scheduler_i++) { // цикл сканирования задач
-        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
-            temp = mRTOS_Tasks[mRTOS_Scheduler_i].Delay; // прочитать значение задержки текущей задачи
-        }
-        if((temp == 0) && (mRTOS_Tasks[mRTOS_Scheduler_i].State == WAIT)) {       // если состояние текущей задачи Wait и задержка истекла, то
+        // обработчик системного тика только обнуляет поле Delay, поэтому при чтении без запрета
+        // прерываний нулевое значение может быть получено только для истёкшей задержки
+        if((mRTOS_Tasks[mRTOS_Scheduler_i].Delay == 0) && (mRTOS_Tasks[mRTOS_Scheduler_i].State == WAIT)) { // если состояние текущей задачи Wait и задержка истекла, то
             mRTOS_Scheduler_pri = mRTOS_Tasks[mRTOS_Scheduler_i].CurrentPriority; // сохранить текущий приоритет этой задачи
             mRTOS_CurrentTask = mRTOS_Scheduler_i;                                // сохранить номер текущей задачи
             break;   // выход из цикла (то есть передать управление этой задаче не зависимо от приоритета)
@@ -259,13 +1559,240 @@ void mRTOS_Scheduler(void) {
     }
     if(mRTOS_FlagSchedulerActive)                           // если флаг активности взведён, то
         mRTOS_Tasks[mRTOS_Scheduler_i_pri].State = ACTIVE;  // установить состояние текущей задачи Active
+#endif
+}
 
-    mRTOS_JmpTask(&mRTOS_Tasks[mRTOS_CurrentTask].Context); // вызвать функцию передачи управления текущей задачи
+#if mRTOS_USE_PREEMPTIVE
+/**
+*  Функция переключения контекста: выбор задачи и установка указателя на
+*  структуру её контекста (вызывается при запрещённых прерываниях)
+*/
+static void mRTOS_SwitchContext(void) __attribute__((noinline));
+static void mRTOS_SwitchContext(void) {
+    if(!mRTOS_FlagStart)                                     // если первый вход в планировщик (при запуске mRTOS), то
+        mRTOS_FlagStart = 1;                                 // взвести флаг признака запуска mRTOS и передать управление первой задаче
+    else
+        mRTOS_SelectTask();                                  // иначе выбрать задачу для выполнения
+    mRTOS_TRACE_SWITCH();                                    // записать переключение задач
+    mRTOS_RUN_START();                                       // начать отсчёт длительности выполнения задачи
+    mRTOS_FlagWake = 0;                                      // запрос вытеснения обработан
+#if mRTOS_TIME_SLICE
+    mRTOS_SliceCounter = 0;                                  // начать новый квант времени
+#endif
+    mRTOS_CurrentContext = &mRTOS_TASK_CONTEXT(mRTOS_CurrentTask); // переключиться на контекст выбранной задачи
+}
+
+/**
+*  Функция планировщика задач (вытесняющий режим): контекст текущей задачи
+*  сохраняется в её стеке, управление передаётся выбранной задаче
+*/
+void mRTOS_Scheduler(void) __attribute__((naked, noinline));
+void mRTOS_Scheduler(void) {
+    mRTOS_SAVE_CONTEXT();                                    // сохранить контекст текущей задачи (при запуске - функции main)
+    mRTOS_SwitchContext();                                   // выбрать задачу для выполнения
+    mRTOS_RESTORE_CONTEXT();                                 // восстановить контекст выбранной задачи
+    asm volatile("ret");                                     // передать управление выбранной задаче
+}
+#elif mRTOS_USE_STACK_SAVE
+/**
+*  Функция переключения сегментов стека: сегмент текущей задачи (от указателя
+*  стека до базы задач) сохраняется в её области сохранения, сегмент выбранной
+*  задачи восстанавливается (вызывается при запрещённых прерываниях на стеке
+*  ниже областей сегментов)
+*/
+static void mRTOS_StackSwitch(void) __attribute__((noinline));
+static void mRTOS_StackSwitch(void) {
+    uint16_t Length;
+    uint8_t i, Prev;
+    uint8_t* StackPtr;
+    if(!mRTOS_FlagStart) {                                   // если первый вход в планировщик (при запуске mRTOS), то
+        mRTOS_FlagStart = 1;                                 // взвести флаг признака запуска mRTOS и передать управление первой задаче
+        Prev = mRTOS_NO_TASK;                                // контекст функции main остаётся выше базы задач
+    } else {
+        Prev = mRTOS_CurrentTask;
+        mRTOS_STACK_SAMPLE(mRTOS_StackTaskMin[Prev], mRTOS_StackSaveSP); // отметить глубину стека текущей задачи
+        Length = mRTOS_StackBase - mRTOS_StackSaveSP;        // длина сегмента стека текущей задачи
+        if(Length > mRTOS_STACK_SAVE_SIZE) {                 // если сегмент не помещается в область сохранения, то
+            mRTOS_StackSaveMax[Prev] = 255;                  // отметить переполнение
+            mRTOS_STACK_SAVE_OVERFLOW(Prev);                 // и выполнить действие при переполнении
+        }
+        mRTOS_StackSaveLength[Prev] = Length;
+        if(Length > mRTOS_StackSaveMax[Prev])
+            mRTOS_StackSaveMax[Prev] = Length;               // обновить наибольшую длину сегмента
+        mRTOS_SelectTask();                                  // выбрать задачу для выполнения
+    }
+    mRTOS_TRACE_SWITCH();                                    // записать переключение задач
+    mRTOS_RUN_START();                                       // начать отсчёт длительности выполнения задачи
+    if(mRTOS_CurrentTask != Prev) {                          // если выбрана другая задача, то
+        if(Prev != mRTOS_NO_TASK) {
+            StackPtr = (uint8_t*)mRTOS_StackSaveSP + 1;      // сохранить сегмент стека текущей задачи
+            for(i = 0; i < mRTOS_StackSaveLength[Prev]; i++)
+                mRTOS_StackSave[Prev][i] = *StackPtr++;
+        }
+        mRTOS_StackSaveSP = mRTOS_StackBase - mRTOS_StackSaveLength[mRTOS_CurrentTask];
+        StackPtr = (uint8_t*)mRTOS_StackSaveSP + 1;          // восстановить сегмент стека выбранной задачи
+        for(i = 0; i < mRTOS_StackSaveLength[mRTOS_CurrentTask]; i++)
+            *StackPtr++ = mRTOS_StackSave[mRTOS_CurrentTask][i];
+    }
+}
+
+/**
+*  Функция планировщика задач (кооперативный режим с сохранением сегмента стека):
+*  регистры, сохраняемые вызываемой функцией, и SREG записываются в стек задачи,
+*  планировщик выполняется на стеке ниже областей сегментов задач
+*/
+void mRTOS_Scheduler(void) __attribute__((naked, noinline));
+void mRTOS_Scheduler(void) {
+    asm volatile(
+                "push r2"                       "\n\t"  // сохранить регистры, сохраняемые вызываемой функцией
+                "push r3"                       "\n\t"
+                "push r4"                       "\n\t"
+                "push r5"                       "\n\t"
+                "push r6"                       "\n\t"
+                "push r7"                       "\n\t"
+                "push r8"                       "\n\t"
+                "push r9"                       "\n\t"
+                "push r10"                      "\n\t"
+                "push r11"                      "\n\t"
+                "push r12"                      "\n\t"
+                "push r13"                      "\n\t"
+                "push r14"                      "\n\t"
+                "push r15"                      "\n\t"
+                "push r16"                      "\n\t"
+                "push r17"                      "\n\t"
+                "push r28"                      "\n\t"
+                "push r29"                      "\n\t"
+                "in   r0, __SREG__"             "\n\t"  // сохранить регистр SREG
+                "cli"                           "\n\t"  // запретить прерывания
+                "push r0"                       "\n\t"
+                "in   r26, __SP_L__"            "\n\t"  // запомнить указатель стека задачи
+                "in   r27, __SP_H__"            "\n\t"
+                "sts  mRTOS_StackSaveSP, r26"   "\n\t"
+                "sts  mRTOS_StackSaveSP+1, r27" "\n\t"
+                "lds  r28, mRTOS_StackBase"     "\n\t"  // прочитать базу задач
+                "lds  r29, mRTOS_StackBase+1"   "\n\t"
+                "mov  r0, r28"                  "\n\t"
+                "or   r0, r29"                  "\n\t"
+                "brne 1f"                       "\n\t"  // если mRTOS не запущена, то
+                "movw r28, r26"                 "\n\t"  // база задач - текущий указатель стека
+                "sts  mRTOS_StackBase, r28"     "\n\t"
+                "sts  mRTOS_StackBase+1, r29"   "\n\t"
+                "1:"                            "\n\t"
+                "subi r28, lo8(%0)"             "\n\t"  // стек планировщика - ниже областей сегментов задач
+                "sbci r29, hi8(%0)"             "\n\t"
+                "out  __SP_L__, r28"            "\n\t"
+                "out  __SP_H__, r29"            "\n\t"
+                :
+                : "i" (mRTOS_STACK_SAVE_SIZE)
+                );
+    mRTOS_StackSwitch();                                     // переключить сегменты стека
+    asm volatile(
+                "lds  r28, mRTOS_StackSaveSP"   "\n\t"  // восстановить указатель стека выбранной задачи
+                "lds  r29, mRTOS_StackSaveSP+1" "\n\t"
+                "out  __SP_L__, r28"            "\n\t"
+                "out  __SP_H__, r29"            "\n\t"
+                "pop  r0"                       "\n\t"  // восстановить регистр SREG
+                "pop  r29"                      "\n\t"  // восстановить регистры, сохраняемые вызываемой функцией
+                "pop  r28"                      "\n\t"
+                "pop  r17"                      "\n\t"
+                "pop  r16"                      "\n\t"
+                "pop  r15"                      "\n\t"
+                "pop  r14"                      "\n\t"
+                "pop  r13"                      "\n\t"
+                "pop  r12"                      "\n\t"
+                "pop  r11"                      "\n\t"
+                "pop  r10"                      "\n\t"
+                "pop  r9"                       "\n\t"
+                "pop  r8"                       "\n\t"
+                "pop  r7"                       "\n\t"
+                "pop  r6"                       "\n\t"
+                "pop  r5"                       "\n\t"
+                "pop  r4"                       "\n\t"
+                "pop  r3"                       "\n\t"
+                "pop  r2"                       "\n\t"
+                "out  __SREG__, r0"             "\n\t"
+                "ret"                           "\n\t"  // вернуться в выбранную задачу
+                );
+}
+#elif mRTOS_PORT_HOST
+/**
+*  Функция планировщика задач (порт для Linux): контекст текущей задачи
+*  сохраняется функцией переключения порта, функция возвращает управление
+*  при следующем выборе текущей задачи (функции main - после mRTOS_PortExit)
+*/
+void mRTOS_Scheduler(void) {
+    uint8_t Prev = mRTOS_NO_TASK;                               // при запуске - контекст функции main
+    if(!mRTOS_FlagStart)                                        // если первый вход в планировщик (при запуске mRTOS), то
+        mRTOS_FlagStart = 1;                                    // взвести флаг признака запуска mRTOS и передать управление первой задаче
+    else {
+        Prev = mRTOS_CurrentTask;
+#if mRTOS_USE_JOBS
+        do {
+            mRTOS_SelectTask();                                 // выбрать задачу для выполнения
+        } while(mRTOS_RunJob());                                // и выполнить задачи-jobs с приоритетом не ниже
+#else
+        mRTOS_SelectTask();                                     // выбрать задачу для выполнения
+#endif
+    }
+    mRTOS_TRACE_SWITCH();                                       // записать переключение задач
+    mRTOS_RUN_START();                                          // начать отсчёт длительности выполнения задачи
+    if(mRTOS_CurrentTask != Prev)                               // если выбрана другая задача, то
+        mRTOS_PortSwitch(Prev, mRTOS_CurrentTask);              // передать ей управление
+}
+#else
+/**
+*  Функция планировщика задач
+*/
+void mRTOS_Scheduler(void) {
+    mRTOS_PORT_CRITICAL() {
+        asm volatile(
+                    "pop  __tmp_reg__"              "\n\t"  // очистить текущее состояние стека
+                    "pop  __tmp_reg__"              "\n\t"
+                    :
+                    :
+                    : "r0"
+                    );
+        // отметка обновляется и обработчиком тика, поэтому сравнение и запись - при запрещённых прерываниях
+        mRTOS_STACK_SAMPLE(mRTOS_StackTaskMin[mRTOS_CurrentTask], SP); // отметить глубину стека текущей задачи
+    }
+    if(!mRTOS_FlagStart) {                                      // если первый вход в планировщик (при запуске mRTOS), то
+        mRTOS_FlagStart = 1;                                    // взвести флаг признака запуска mRTOS
+        mRTOS_TRACE_SWITCH();                                   // записать запуск первой задачи
+        mRTOS_RUN_START();                                      // начать отсчёт длительности выполнения задачи
+        mRTOS_JmpTask(&mRTOS_TASK_CONTEXT(mRTOS_CurrentTask)); // вызывать функцию передачи управление первой задаче
+    }
+#if mRTOS_USE_JOBS
+    do {
+        mRTOS_SelectTask();                                     // выбрать задачу для выполнения
+    } while(mRTOS_RunJob());                                    // и выполнить задачи-jobs с приоритетом не ниже, после каждой выбрать задачу заново
+#else
+    mRTOS_SelectTask();                                         // выбрать задачу для выполнения
+#endif
+    mRTOS_TRACE_SWITCH();                                       // записать переключение задач
+    mRTOS_RUN_START();                                          // начать отсчёт длительности выполнения задачи
+    mRTOS_JmpTask(&mRTOS_TASK_CONTEXT(mRTOS_CurrentTask)); // вызвать функцию передачи управления текущей задачи
+}
+#endif
+
+/**
+* Функция пробуждения задачи, закреплённой за событием, если она ожидает
+* это событие (вызывается при запрещённых прерываниях)
+* входной параметр:
+* \param EventNumber - номер события
+*/
+static inline void mRTOS_WakeEventTask(uint8_t EventNumber) {
+    uint8_t task = mRTOS_EVENT_TASK(EventNumber);
+    if((mRTOS_TASK_STATE(task) == SEMAPHORE) &&                 // если задача ожидает
+       (mRTOS_WaitObject[task] == &mRTOS_Events[EventNumber])) { // это событие, то
+        mRTOS_DelayRemove(task);                                 // отменить тайм-аут
+        mRTOS_WakeTask(task);                                    // и пробудить задачу
+    }
 }
 
 /**
 * Функция инициализации события (закрепление события за текущей задачей,
-* разрешение события и сброс флага события)
+* разрешение события и сброс флага события; при статической таблице событий
+* задача берётся из таблицы)
 * входной параметр:
 * \param EventNumber - номер события закрепляемый за текущей задачей
 * возвращает:
@@ -275,8 +1802,10 @@ void mRTOS_Scheduler(void) {
 uint8_t mRTOS_InitEvent(uint8_t EventNumber) {
     if(EventNumber >= mRTOS_MAX_EVENTS)    // если номер события не верный, то
         return 0;                          // выход с кодом ошибки
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    mRTOS_PORT_CRITICAL() {
+#if !mRTOS_USE_STATIC_TASKS
         mRTOS_Events[EventNumber].TaskNumber = mRTOS_CurrentTask; // сохранить номер текущей задачи в структуре события
+#endif
         mRTOS_Events[EventNumber].FlagControlEvent = 1;           // взвести флаг разрешения события
         mRTOS_Events[EventNumber].FlagEvent = 0;                  // сбросить флаг события
     }
@@ -294,7 +1823,7 @@ uint8_t mRTOS_InitEvent(uint8_t EventNumber) {
 uint8_t mRTOS_DisableEvent(uint8_t EventNumber) {
     if(EventNumber >= mRTOS_MAX_EVENTS)  // если номер события не верный, то
         return 0;                        // выход с кодом ошибки
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    mRTOS_PORT_CRITICAL() {
         mRTOS_Events[EventNumber].FlagControlEvent = 0; // сбросить флаг разрешения события (запретить событие)
     }
     return 1;                            // выход с кодом успешного выполнения
@@ -311,7 +1840,7 @@ uint8_t mRTOS_DisableEvent(uint8_t EventNumber) {
 uint8_t mRTOS_EnableEvent(uint8_t EventNumber) {
     if(EventNumber >= mRTOS_MAX_EVENTS)  // если номер события не верный, то
         return 0;                        // выход с кодом ошибки
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    mRTOS_PORT_CRITICAL() {
         mRTOS_Events[EventNumber].FlagControlEvent = 1; // взвести флаг разрешения события (разрешить событие)
     }
     return 1;                            // выход с кодом успешного выполнения
@@ -328,9 +1857,11 @@ uint8_t mRTOS_EnableEvent(uint8_t EventNumber) {
 uint8_t mRTOS_SetEvent(uint8_t EventNumber) {
     if(EventNumber >= mRTOS_MAX_EVENTS)  // если номер события не верный, то
         return 0;                        // выход с кодом ошибки
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
-        if(mRTOS_Events[EventNumber].FlagControlEvent) // если флаг разрешения события взведён, то
-            mRTOS_Events[EventNumber].FlagEvent++;     // инкремент флага события
+    mRTOS_PORT_CRITICAL() {
+        if(mRTOS_Events[EventNumber].FlagControlEvent) { // если флаг разрешения события взведён, то
+            mRTOS_Events[EventNumber].FlagEvent++;       // инкремент флага события
+            mRTOS_WakeEventTask(EventNumber);            // пробудить задачу, ожидающую событие
+        }
     }
     return 1;                            // выход с кодом успешного выполнения
 }
@@ -347,9 +1878,12 @@ uint8_t mRTOS_SetEvent(uint8_t EventNumber) {
 uint8_t mRTOS_SetEventValue(uint8_t EventNumber, uint8_t FlagEventValue) {
     if(EventNumber >= mRTOS_MAX_EVENTS)  // если номер события не верный, то
         return 0;                        // выход с кодом ошибки
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
-        if(mRTOS_Events[EventNumber].FlagControlEvent)            // если флаг разрешения события взведён, то
+    mRTOS_PORT_CRITICAL() {
+        if(mRTOS_Events[EventNumber].FlagControlEvent) {          // если флаг разрешения события взведён, то
             mRTOS_Events[EventNumber].FlagEvent = FlagEventValue; // инициализировать значение флага события
+            if(FlagEventValue)                                    // если событие произошло, то
+                mRTOS_WakeEventTask(EventNumber);                 // пробудить задачу, ожидающую событие
+        }
     }
     return 1;                            // выход с кодом успешного выполнения
 }
@@ -367,7 +1901,7 @@ uint8_t mRTOS_GetEvent(uint8_t EventNumber) {
     uint8_t temp=0;
     if(EventNumber >= mRTOS_MAX_EVENTS)  // если номер события не верный, то
         return temp;                     // выход с возвратом 0
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    mRTOS_PORT_CRITICAL() {
         if(mRTOS_Events[EventNumber].FlagControlEvent) { // если событие разрешено, то
             temp = mRTOS_Events[EventNumber].FlagEvent;  // прочитать значение флага события
             mRTOS_Events[EventNumber].FlagEvent = 0;     // сбросить флаг события
@@ -388,21 +1922,485 @@ uint8_t mRTOS_PopEvent(uint8_t EventNumber) {
     uint8_t temp=0;
     if(EventNumber >= mRTOS_MAX_EVENTS)  // если номер события не верный, то
         return temp;                     // выход с возвратом 0
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    mRTOS_PORT_CRITICAL() {
         if(mRTOS_Events[EventNumber].FlagControlEvent)  // если событие разрешено, то
             temp = mRTOS_Events[EventNumber].FlagEvent; // прочитать значение флага события
     }
     return temp;                         // выход с возвратом флага события
 }
 
+/**
+* Функция изменения приоритета задачи (вызывается при запрещённых прерываниях)
+* входные параметры:
+* \param TaskNumber - номер задачи
+* \param Priority - новый приоритет задачи
+*/
+static void mRTOS_ChangePriority(uint8_t TaskNumber, uint8_t Priority) {
+#if mRTOS_USE_BITMAP_SCHEDULER
+    mRTOS_ReadyRemove(TaskNumber);                       // исключить задачу из битовых карт готовности прежнего уровня
+#endif
+    if((Priority > mRTOS_TASK_PRIORITY(TaskNumber)) ||  // при повышении приоритета или если текущий приоритет
+       (mRTOS_TASK_CREDIT(TaskNumber) > Priority)) // превышает новый приоритет задачи,
+        mRTOS_TASK_CREDIT(TaskNumber) = Priority;  // установить текущий приоритет равным новому
+    mRTOS_TASK_PRIORITY(TaskNumber) = Priority;         // установить приоритет задачи
+#if mRTOS_USE_BITMAP_SCHEDULER
+    mRTOS_ReadyUpdate(TaskNumber);                       // включить задачу в битовые карты готовности нового уровня
+#endif
+}
+
+/**
+* Функция перевода текущей задачи в состояние Semaphore с включением в список
+* ожидания объекта, упорядоченный по приоритету (вызывается при запрещённых
+* прерываниях)
+* входные параметры:
+* \param WaitListPtr - указатель на номер первой задачи списка ожидания
+* \param Object - указатель на ожидаемый объект
+*/
+static void mRTOS_WaitListInsert(uint8_t* WaitListPtr, const volatile void* Object) {
+    uint8_t next;
+    mRTOS_TASK_STATE(mRTOS_CurrentTask) = SEMAPHORE;    // установить состояние текущей задачи в Semaphore
+    mRTOS_WaitObject[mRTOS_CurrentTask] = Object;        // запомнить ожидаемый объект
+#if mRTOS_USE_BITMAP_SCHEDULER
+    mRTOS_ReadyRemove(mRTOS_CurrentTask);                // исключить текущую задачу из битовых карт готовности
+#endif
+    while(((next = *WaitListPtr) != mRTOS_NO_TASK) &&   // поиск места задачи в списке (после задач с не меньшим приоритетом)
+          (mRTOS_TASK_PRIORITY(next) >= mRTOS_TASK_PRIORITY(mRTOS_CurrentTask)))
+        WaitListPtr = &mRTOS_WaitNext[next];
+    mRTOS_WaitNext[mRTOS_CurrentTask] = next;
+    *WaitListPtr = mRTOS_CurrentTask;
+}
+
+/**
+* Функция исключения первой задачи из списка ожидания объекта с её
+* пробуждением (вызывается при запрещённых прерываниях)
+* входной параметр:
+* \param WaitListPtr - указатель на номер первой задачи списка ожидания
+* возвращает:
+* \return номер пробуждённой задачи или mRTOS_NO_TASK, если список пуст
+*/
+static inline uint8_t mRTOS_WaitListWake(uint8_t* WaitListPtr) {
+    uint8_t task = *WaitListPtr;
+    if(task != mRTOS_NO_TASK) {                          // если список не пуст, то
+        *WaitListPtr = mRTOS_WaitNext[task];             // исключить первую задачу из списка
+        mRTOS_WakeTask(task);                            // и пробудить её
+    }
+    return task;
+}
+
+/**
+* Функция инициализации счётного семафора
+* входные параметры:
+* \param SemaphorePtr - указатель на структуру семафора
+* \param Count - начальное значение счётчика семафора
+*/
+void mRTOS_InitSemaphore(struct Semaphore* SemaphorePtr, uint8_t Count) {
+    mRTOS_PORT_CRITICAL() {
+        SemaphorePtr->Count = Count;             // установить значение счётчика семафора
+        SemaphorePtr->WaitList = mRTOS_NO_TASK;  // очистить список ожидания
+    }
+}
+
+/**
+* Функция включения текущей задачи в список ожидания семафора; если семафор
+* был освобождён после сохранения контекста задачи, то задача захватывает
+* его и сразу пробуждается
+* входной параметр:
+* \param SemaphorePtr - указатель на структуру семафора
+*/
+static void mRTOS_SemaphoreBlock(struct Semaphore* SemaphorePtr) __attribute__((noinline));
+static void mRTOS_SemaphoreBlock(struct Semaphore* SemaphorePtr) {
+    mRTOS_PORT_CRITICAL() {
+        if(SemaphorePtr->Count) {                // если семафор свободен, то
+            SemaphorePtr->Count--;               // захватить его
+            mRTOS_WakeTask(mRTOS_CurrentTask);   // и продолжить выполнение текущей задачи
+        } else
+            mRTOS_WaitListInsert(&SemaphorePtr->WaitList, SemaphorePtr); // иначе ожидать семафор
+    }
+}
+
+/**
+* Функция ожидания (захвата) счётного семафора: если счётчик семафора
+* не нулевой, он уменьшается, иначе текущая задача переводится в состояние
+* Semaphore до освобождения семафора
+* входные параметры:
+* \param SemaphorePtr - указатель на структуру семафора;
+* \param TaskContextPtr - указатель на структуру контекста текущей задачи.
+*/
+void mRTOS_WaitSemaphore(struct Semaphore* SemaphorePtr, struct TaskContext* TaskContextPtr) __attribute__((noinline));
+void mRTOS_WaitSemaphore(struct Semaphore* SemaphorePtr, struct TaskContext* TaskContextPtr) {
+    mRTOS_PORT_CRITICAL() {
+        if(SemaphorePtr->Count) {                // если семафор свободен, то
+            SemaphorePtr->Count--;               // захватить его
+            return;                              // и выйти без ожидания
+        }
+        mRTOS_SAVE_RETURN_CONTEXT(TaskContextPtr); // сохранить контекст текущей задачи
+    }
+    mRTOS_SemaphoreBlock(SemaphorePtr);          // включить текущую задачу в список ожидания семафора
+    mRTOS_TRACE_REASON(mRTOS_TRACE_SEMAPHORE);
+    mRTOS_Scheduler();                           // вызвать функцию планировщика задач
+}
+
+/**
+* Функция захвата счётного семафора без ожидания
+* входной параметр:
+* \param SemaphorePtr - указатель на структуру семафора
+* возвращает:
+* \return 1 - семафор захвачен
+* \return 0 - семафор занят
+*/
+uint8_t mRTOS_TryWaitSemaphore(struct Semaphore* SemaphorePtr) {
+    uint8_t temp = 0;
+    mRTOS_PORT_CRITICAL() {
+        if(SemaphorePtr->Count) {                // если семафор свободен, то
+            SemaphorePtr->Count--;               // захватить его
+            temp = 1;
+        }
+    }
+    return temp;
+}
+
+/**
+* Функция освобождения счётного семафора: если семафор ожидают задачи,
+* он передаётся задаче с наибольшим приоритетом, иначе счётчик семафора
+* увеличивается (допускается вызов из прерывания)
+* входной параметр:
+* \param SemaphorePtr - указатель на структуру семафора
+* возвращает:
+* \return 1 - семафор успешно освобождён
+* \return 0 - ошибка, переполнение счётчика семафора
+*/
+uint8_t mRTOS_SignalSemaphore(struct Semaphore* SemaphorePtr) {
+    uint8_t temp = 1;
+    mRTOS_PORT_CRITICAL() {
+        if(mRTOS_WaitListWake(&SemaphorePtr->WaitList) == mRTOS_NO_TASK) { // если семафор никто не ожидает, то
+            if(SemaphorePtr->Count != 0xFF)      // если счётчик не переполнен, то
+                SemaphorePtr->Count++;           // инкремент счётчика семафора
+            else
+                temp = 0;
+        }
+    }
+    return temp;
+}
+
+/**
+* Функция инициализации мьютекса
+* входной параметр:
+* \param MutexPtr - указатель на структуру мьютекса
+*/
+void mRTOS_InitMutex(struct Mutex* MutexPtr) {
+    mRTOS_PORT_CRITICAL() {
+        MutexPtr->Owner = mRTOS_NO_TASK;         // мьютекс свободен
+        MutexPtr->WaitList = mRTOS_NO_TASK;      // очистить список ожидания
+    }
+}
+
+/**
+* Функция захвата свободного мьютекса задачей (вызывается при запрещённых
+* прерываниях)
+* входные параметры:
+* \param MutexPtr - указатель на структуру мьютекса
+* \param TaskNumber - номер задачи
+*/
+static inline void mRTOS_MutexTake(struct Mutex* MutexPtr, uint8_t TaskNumber) {
+    MutexPtr->Owner = TaskNumber;                                   // задача - владелец мьютекса
+    MutexPtr->OwnerPriority = mRTOS_TASK_PRIORITY(TaskNumber);     // запомнить её приоритет
+    mRTOS_MutexHeld[TaskNumber] = 1;
+}
+
+/**
+* Функция включения текущей задачи в список ожидания мьютекса с
+* наследованием приоритета: если приоритет текущей задачи выше приоритета
+* владельца мьютекса, владелец получает приоритет текущей задачи
+* входной параметр:
+* \param MutexPtr - указатель на структуру мьютекса
+*/
+static void mRTOS_MutexBlock(struct Mutex* MutexPtr) __attribute__((noinline));
+static void mRTOS_MutexBlock(struct Mutex* MutexPtr) {
+    mRTOS_PORT_CRITICAL() {
+        if(MutexPtr->Owner == mRTOS_NO_TASK) {   // если мьютекс освобождён после сохранения контекста, то
+            mRTOS_MutexTake(MutexPtr, mRTOS_CurrentTask); // захватить его
+            mRTOS_WakeTask(mRTOS_CurrentTask);   // и продолжить выполнение текущей задачи
+        } else {
+            mRTOS_WaitListInsert(&MutexPtr->WaitList, MutexPtr); // иначе ожидать мьютекс
+            if(mRTOS_TASK_PRIORITY(MutexPtr->Owner) < mRTOS_TASK_PRIORITY(mRTOS_CurrentTask)) // если приоритет владельца ниже, то
+                mRTOS_ChangePriority(MutexPtr->Owner, mRTOS_TASK_PRIORITY(mRTOS_CurrentTask)); // владелец наследует приоритет текущей задачи
+        }
+    }
+}
+
+/**
+* Функция захвата мьютекса: если мьютекс занят, текущая задача переводится
+* в состояние Semaphore до его освобождения; если текущая задача уже
+* владеет мьютексом, выполняется действие mRTOS_MUTEX_NESTED и мьютекс
+* не захватывается
+* входные параметры:
+* \param MutexPtr - указатель на структуру мьютекса;
+* \param TaskContextPtr - указатель на структуру контекста текущей задачи.
+*/
+void mRTOS_LockMutex(struct Mutex* MutexPtr, struct TaskContext* TaskContextPtr) __attribute__((noinline));
+void mRTOS_LockMutex(struct Mutex* MutexPtr, struct TaskContext* TaskContextPtr) {
+    mRTOS_PORT_CRITICAL() {
+        if(mRTOS_MutexHeld[mRTOS_CurrentTask]) { // если текущая задача уже владеет мьютексом, то
+            mRTOS_MUTEX_NESTED(mRTOS_CurrentTask); // выполнить действие при вложенном захвате
+            return;                              // и выйти без захвата
+        }
+        if(MutexPtr->Owner == mRTOS_NO_TASK) {   // если мьютекс свободен, то
+            mRTOS_MutexTake(MutexPtr, mRTOS_CurrentTask); // захватить его
+            return;                              // и выйти без ожидания
+        }
+        mRTOS_SAVE_RETURN_CONTEXT(TaskContextPtr); // сохранить контекст текущей задачи
+    }
+    mRTOS_MutexBlock(MutexPtr);                  // включить текущую задачу в список ожидания мьютекса
+    mRTOS_TRACE_REASON(mRTOS_TRACE_MUTEX);
+    mRTOS_Scheduler();                           // вызвать функцию планировщика задач
+}
+
+/**
+* Функция захвата мьютекса без ожидания
+* входной параметр:
+* \param MutexPtr - указатель на структуру мьютекса
+* возвращает:
+* \return 1 - мьютекс захвачен
+* \return 0 - мьютекс занят или текущая задача уже владеет мьютексом
+*/
+uint8_t mRTOS_TryLockMutex(struct Mutex* MutexPtr) {
+    uint8_t temp = 0;
+    mRTOS_PORT_CRITICAL() {
+        if((MutexPtr->Owner == mRTOS_NO_TASK) && // если мьютекс свободен и
+           !mRTOS_MutexHeld[mRTOS_CurrentTask]) { // текущая задача не владеет другим мьютексом, то
+            mRTOS_MutexTake(MutexPtr, mRTOS_CurrentTask); // захватить его
+            temp = 1;
+        }
+    }
+    return temp;
+}
+
+/**
+* Функция освобождения мьютекса задачей-владельцем: приоритет задачи
+* восстанавливается, мьютекс передаётся ожидающей задаче с наибольшим
+* приоритетом
+* входной параметр:
+* \param MutexPtr - указатель на структуру мьютекса
+* возвращает:
+* \return 1 - мьютекс успешно освобождён
+* \return 0 - ошибка, текущая задача не является владельцем мьютекса
+*/
+uint8_t mRTOS_UnlockMutex(struct Mutex* MutexPtr) {
+    uint8_t task;
+    mRTOS_PORT_CRITICAL() {
+        if(MutexPtr->Owner != mRTOS_CurrentTask) // если текущая задача не владелец мьютекса, то
+            return 0;                            // выход с кодом ошибки
+        if(mRTOS_TASK_PRIORITY(mRTOS_CurrentTask) != MutexPtr->OwnerPriority) // если приоритет был унаследован, то
+            mRTOS_ChangePriority(mRTOS_CurrentTask, MutexPtr->OwnerPriority);  // восстановить приоритет текущей задачи
+        mRTOS_MutexHeld[mRTOS_CurrentTask] = 0;
+        task = mRTOS_WaitListWake(&MutexPtr->WaitList); // пробудить ожидающую задачу с наибольшим приоритетом
+        MutexPtr->Owner = task;                  // и передать ей мьютекс (или освободить мьютекс)
+        if(task != mRTOS_NO_TASK) {
+            MutexPtr->OwnerPriority = mRTOS_TASK_PRIORITY(task);
+            mRTOS_MutexHeld[task] = 1;
+            if((MutexPtr->WaitList != mRTOS_NO_TASK) && // если мьютекс ожидают другие задачи с более высоким приоритетом, то
+               (mRTOS_TASK_PRIORITY(MutexPtr->WaitList) > mRTOS_TASK_PRIORITY(task)))
+                mRTOS_ChangePriority(task, mRTOS_TASK_PRIORITY(MutexPtr->WaitList)); // новый владелец наследует их приоритет
+        }
+    }
+    return 1;
+}
+
+#if mRTOS_USE_EVENT_GROUPS
+/**
+* Функция инициализации группы флагов событий
+* входной параметр:
+* \param GroupPtr - указатель на структуру группы событий
+*/
+void mRTOS_InitEventGroup(struct EventGroup* GroupPtr) {
+    mRTOS_PORT_CRITICAL() {
+        GroupPtr->Flags = 0;                     // сбросить флаги группы
+        GroupPtr->WaitList = mRTOS_NO_TASK;      // очистить список ожидания
+    }
+}
+
+/**
+* Функция проверки условия ожидания флагов группы событий; при выполнении
+* условия запоминается результат ожидания задачи (вызывается при запрещённых
+* прерываниях)
+* входные параметры:
+* \param Flags - флаги группы событий;
+* \param Mask - маска ожидаемых флагов;
+* \param Mode - режим ожидания (mRTOS_FLAGS_xxx);
+* \param TaskNumber - номер задачи.
+* возвращает:
+* \return 1 - условие ожидания выполнено
+* \return 0 - условие ожидания не выполнено
+*/
+static inline uint8_t mRTOS_EventFlagsMatch(mRTOS_EventFlags Flags, mRTOS_EventFlags Mask, uint8_t Mode, uint8_t TaskNumber) {
+    Flags &= Mask;
+    if((Mode & mRTOS_FLAGS_ALL) ? (Flags != Mask) : !Flags) // если не установлены все (любой) флаги маски, то
+        return 0;                                // условие не выполнено
+    mRTOS_WaitFlags[TaskNumber] = Flags;         // результат ожидания - установленные флаги маски
+    return 1;
+}
+
+/**
+* Функция получения флагов группы событий текущей задачей без ожидания: при
+* выполнении условия ожидания флаги маски сбрасываются, если задан режим
+* mRTOS_FLAGS_CLEAR (вызывается при запрещённых прерываниях)
+* входные параметры:
+* \param GroupPtr - указатель на структуру группы событий;
+* \param Mask - маска ожидаемых флагов;
+* \param Mode - режим ожидания (mRTOS_FLAGS_xxx).
+* возвращает:
+* \return 1 - условие ожидания выполнено
+* \return 0 - условие ожидания не выполнено
+*/
+static inline uint8_t mRTOS_EventFlagsTake(struct EventGroup* GroupPtr, mRTOS_EventFlags Mask, uint8_t Mode) {
+    if(!mRTOS_EventFlagsMatch(GroupPtr->Flags, Mask, Mode, mRTOS_CurrentTask))
+        return 0;
+    if(Mode & mRTOS_FLAGS_CLEAR)                 // если задан сброс флагов при выходе, то
+        GroupPtr->Flags &= ~Mask;                // сбросить флаги маски
+    return 1;
+}
+
+/**
+* Функция установки флагов группы событий: за один проход по списку
+* ожидания пробуждаются все задачи, условие ожидания которых выполнено;
+* флаги, сбрасываемые при выходе из ожидания (mRTOS_FLAGS_CLEAR), сбрасываются
+* после прохода, поэтому все задачи проверяются по одним и тем же флагам
+* (допускается вызов из прерывания)
+* входные параметры:
+* \param GroupPtr - указатель на структуру группы событий;
+* \param Flags - устанавливаемые флаги.
+* возвращает:
+* \return флаги группы после установки и сброса флагов пробуждёнными задачами
+*/
+mRTOS_EventFlags mRTOS_SetEventFlags(struct EventGroup* GroupPtr, mRTOS_EventFlags Flags) {
+    uint8_t* LinkPtr = &GroupPtr->WaitList;
+    uint8_t task;
+    mRTOS_EventFlags mask, clear = 0;
+    mRTOS_PORT_CRITICAL() {
+        Flags |= GroupPtr->Flags;
+        while((task = *LinkPtr) != mRTOS_NO_TASK) { // цикл по задачам списка ожидания группы
+            mask = mRTOS_WaitFlags[task];
+            if(mRTOS_EventFlagsMatch(Flags, mask, mRTOS_WaitMode[task], task)) { // если условие ожидания задачи выполнено, то
+                *LinkPtr = mRTOS_WaitNext[task]; // исключить задачу из списка ожидания
+                if(mRTOS_WaitMode[task] & mRTOS_FLAGS_CLEAR) // если задан сброс флагов при выходе, то
+                    clear |= mask;               // сбросить флаги маски после прохода по списку
+                mRTOS_WaitMode[task] = 0;
+                mRTOS_DelayRemove(task);         // отменить тайм-аут
+                mRTOS_WakeTask(task);            // и пробудить задачу
+            } else
+                LinkPtr = &mRTOS_WaitNext[task];
+        }
+        Flags &= ~clear;
+        GroupPtr->Flags = Flags;
+    }
+    return Flags;
+}
+
+/**
+* Функция сброса флагов группы событий (допускается вызов из прерывания)
+* входные параметры:
+* \param GroupPtr - указатель на структуру группы событий;
+* \param Flags - сбрасываемые флаги.
+* возвращает:
+* \return флаги группы до сброса
+*/
+mRTOS_EventFlags mRTOS_ClearEventFlags(struct EventGroup* GroupPtr, mRTOS_EventFlags Flags) {
+    mRTOS_EventFlags temp;
+    mRTOS_PORT_CRITICAL() {
+        temp = GroupPtr->Flags;
+        GroupPtr->Flags = temp & ~Flags;
+    }
+    return temp;
+}
+
+/**
+* Функция чтения флагов группы событий
+* входной параметр:
+* \param GroupPtr - указатель на структуру группы событий
+* возвращает:
+* \return флаги группы
+*/
+mRTOS_EventFlags mRTOS_GetEventFlags(struct EventGroup* GroupPtr) {
+    mRTOS_EventFlags temp;
+    mRTOS_PORT_CRITICAL() {
+        temp = GroupPtr->Flags;
+    }
+    return temp;
+}
+
+/**
+* Функция включения текущей задачи в список ожидания группы событий и в
+* список задержек (если задан тайм-аут); если флаги были установлены после
+* сохранения контекста задачи, то задача сразу пробуждается
+* входные параметры:
+* \param GroupPtr - указатель на структуру группы событий;
+* \param Mask - маска ожидаемых флагов;
+* \param Mode - режим ожидания (mRTOS_FLAGS_xxx);
+* \param Timeout - тайм-аут в тиках (0 - без тайм-аута).
+*/
+static void mRTOS_EventFlagsBlock(struct EventGroup* GroupPtr, mRTOS_EventFlags Mask, uint8_t Mode, uint16_t Timeout) __attribute__((noinline));
+static void mRTOS_EventFlagsBlock(struct EventGroup* GroupPtr, mRTOS_EventFlags Mask, uint8_t Mode, uint16_t Timeout) {
+    mRTOS_PORT_CRITICAL() {
+        if(mRTOS_EventFlagsTake(GroupPtr, Mask, Mode)) // если условие ожидания уже выполнено, то
+            mRTOS_WakeTask(mRTOS_CurrentTask);   // продолжить выполнение текущей задачи
+        else {
+            mRTOS_WaitListInsert(&GroupPtr->WaitList, GroupPtr); // иначе ожидать флаги группы
+            mRTOS_WaitFlags[mRTOS_CurrentTask] = Mask;
+            mRTOS_WaitMode[mRTOS_CurrentTask] = Mode | mRTOS_FLAGS_WAITING;
+            mRTOS_DelayInsert(mRTOS_CurrentTask, Timeout); // включить текущую задачу в список задержек (если задан тайм-аут)
+        }
+    }
+}
+
+/**
+* Функция ожидания флагов группы событий: если условие ожидания выполнено,
+* задача продолжает выполнение, иначе переводится в состояние Semaphore до
+* установки флагов или до истечения тайм-аута. После возврата в задачу
+* результат читается функцией mRTOS_GetWaitFlags (0 - истёк тайм-аут).
+* входные параметры:
+* \param GroupPtr - указатель на структуру группы событий;
+* \param Mask - маска ожидаемых флагов (не 0);
+* \param Mode - режим ожидания: mRTOS_FLAGS_ANY - любой флаг маски,
+*               mRTOS_FLAGS_ALL - все флаги маски, с mRTOS_FLAGS_CLEAR -
+*               флаги маски сбрасываются при выходе из ожидания;
+* \param Timeout - тайм-аут в тиках (0 - без тайм-аута);
+* \param TaskContextPtr - указатель на структуру контекста текущей задачи.
+*/
+void mRTOS_WaitEventFlags(struct EventGroup* GroupPtr, mRTOS_EventFlags Mask, uint8_t Mode, uint16_t Timeout, struct TaskContext* TaskContextPtr) __attribute__((noinline));
+void mRTOS_WaitEventFlags(struct EventGroup* GroupPtr, mRTOS_EventFlags Mask, uint8_t Mode, uint16_t Timeout, struct TaskContext* TaskContextPtr) {
+    mRTOS_PORT_CRITICAL() {
+        if(mRTOS_EventFlagsTake(GroupPtr, Mask, Mode)) // если условие ожидания выполнено, то
+            return;                              // выход без ожидания
+        mRTOS_SAVE_RETURN_CONTEXT(TaskContextPtr); // сохранить контекст текущей задачи
+    }
+    mRTOS_EventFlagsBlock(GroupPtr, Mask, Mode, Timeout); // включить текущую задачу в список ожидания группы
+    mRTOS_TRACE_REASON(mRTOS_TRACE_EVENT);
+    mRTOS_Scheduler();                           // вызвать функцию планировщика задач
+}
+
+/**
+* Функция чтения результата последнего ожидания флагов группы событий
+* текущей задачей
+* возвращает:
+* \return дождавшиеся флаги маски (до сброса при выходе из ожидания)
+* \return 0 - истёк тайм-аут
+*/
+mRTOS_EventFlags mRTOS_GetWaitFlags(void) {
+    return mRTOS_WaitFlags[mRTOS_CurrentTask];
+}
+#endif
+
 /**
 * Функция установки состояния текущей задачи
 * входной параметр:
 * \param Status - устанавливаемое состояние текущей задачи
 */
 void mRTOS_SetTaskStatus(enum TaskState Status) {
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
-        mRTOS_Tasks[mRTOS_CurrentTask].State = Status; // установить состояние текущей задачи
+    mRTOS_PORT_CRITICAL() {
+        mRTOS_TASK_STATE(mRTOS_CurrentTask) = Status; // установить состояние текущей задачи
+#if mRTOS_USE_BITMAP_SCHEDULER
+        mRTOS_ReadyUpdate(mRTOS_CurrentTask);          // привести битовые карты готовности в соответствие состоянию
+#endif
     }
 }
 
@@ -418,33 +2416,334 @@ void mRTOS_SetTaskStatus(enum TaskState Status) {
 uint8_t mRTOS_SetTaskNStatus(uint8_t TaskNumber, enum TaskState Status) {
     if(TaskNumber >= mRTOS_MAX_TASKS)    // если номер задачи неверный, то
         return 0;                        // выход с кодом ошибки
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
-        if(mRTOS_Tasks[TaskNumber].State == STOP)   // если заданная задача остановлена, то
-            mRTOS_Tasks[TaskNumber].State = Status; // установить состояние этой задачи
+    mRTOS_PORT_CRITICAL() {
+        if(mRTOS_TASK_STATE(TaskNumber) == STOP) { // если заданная задача остановлена, то
+            mRTOS_TASK_STATE(TaskNumber) = Status; // установить состояние этой задачи
+#if mRTOS_USE_BITMAP_SCHEDULER
+            mRTOS_ReadyUpdate(TaskNumber);          // привести битовые карты готовности в соответствие состоянию
+#endif
+#if mRTOS_USE_PREEMPTIVE
+            if((Status == ACTIVE) && mRTOS_Preempts(TaskNumber)) // если задача стала готовой к выполнению и важнее текущей, то
+                mRTOS_FlagWake = 1;                 // запросить вытеснение текущей задачи
+#endif
+        }
     }
     return 1;                            // выход с кодом успешного выполнения
 }
 
+#if mRTOS_USE_PERIODIC_TASKS
+/**
+* Функция задания периода выпуска задачи: моменты выпуска отсчитываются от
+* текущего времени, первый выпуск - через Period тиков
+* входные параметры:
+* \param TaskNumber - номер задачи;
+* \param Period - период выпуска в тиках (0 - задача не периодическая).
+* возвращает:
+* \return 1 - период задан
+* \return 0 - ошибка, номер задачи неверный
+*/
+uint8_t mRTOS_SetTaskPeriod(uint8_t TaskNumber, uint16_t Period) {
+    if(TaskNumber >= mRTOS_MAX_TASKS)    // если номер задачи неверный, то
+        return 0;                        // выход с кодом ошибки
+    mRTOS_PORT_CRITICAL() {
+        mRTOS_TaskRelease[TaskNumber] = mRTOS_SystemTime; // начало отсчёта моментов выпуска
+        mRTOS_TaskPeriod[TaskNumber] = Period;
+        mRTOS_TaskMissed[TaskNumber] = 0;
+    }
+    return 1;                            // выход с кодом успешного выполнения
+}
+
+/**
+* Функция чтения количества пропущенных выпусков периодической задачи
+* (выпусков, наступивших до вызова mRTOS_TASK_WAIT_PERIOD)
+* входной параметр:
+* \param TaskNumber - номер задачи
+* возвращает:
+* \return количество пропущенных выпусков (до 255)
+* \return 0 - номер задачи неверный
+*/
+uint8_t mRTOS_GetTaskMissed(uint8_t TaskNumber) {
+    if(TaskNumber >= mRTOS_MAX_TASKS)    // если номер задачи неверный, то
+        return 0;                        // выход с кодом ошибки
+    return mRTOS_TaskMissed[TaskNumber];
+}
+#endif
+
+#if mRTOS_USE_JOBS
+/**
+* Функция создания задачи выполнения до завершения (job)
+* входные параметры:
+* \param Job - указатель на функцию задачи-job;
+* \param Priority - приоритет задачи-job (сравнивается с приоритетами обычных задач).
+* возвращает:
+* \return 1 - задача-job создана (номер - количество ранее созданных задач-jobs)
+* \return 0 - ошибка, создано mRTOS_MAX_JOBS задач-jobs
+*/
+uint8_t mRTOS_CreateJob(void (*Job)(void), uint8_t Priority) {
+    uint8_t n = mRTOS_InitJobsCounter;
+    if(n >= mRTOS_MAX_JOBS)              // если задачи-jobs исчерпаны, то
+        return 0;                        // выход с кодом ошибки
+    mRTOS_JobFunction[n] = Job;
+    mRTOS_JobPriority[n] = Priority;
+    mRTOS_JobPeriod[n] = 0;
+    mRTOS_JobCounter[n] = 0;
+    mRTOS_PORT_CRITICAL() {
+        mRTOS_InitJobsCounter = n + 1;   // задача-job доступна планировщику и системному тику
+    }
+    return 1;                            // выход с кодом успешного выполнения
+}
+
+/**
+* Функция запроса выполнения задачи-job (повторные запросы до выполнения
+* объединяются)
+* входной параметр:
+* \param JobNumber - номер задачи-job
+* возвращает:
+* \return 1 - выполнение запрошено
+* \return 0 - ошибка, номер задачи-job неверный
+*/
+uint8_t mRTOS_PostJob(uint8_t JobNumber) {
+    if(JobNumber >= mRTOS_InitJobsCounter) // если номер задачи-job неверный, то
+        return 0;                        // выход с кодом ошибки
+    mRTOS_PORT_CRITICAL() {
+        mRTOS_JobPending |= 1 << JobNumber;
+    }
+    return 1;                            // выход с кодом успешного выполнения
+}
+
+/**
+* Функция задания периода выполнения задачи-job: первое выполнение - через
+* Period тиков
+* входные параметры:
+* \param JobNumber - номер задачи-job;
+* \param Period - период в тиках (0 - задача-job не периодическая).
+* возвращает:
+* \return 1 - период задан
+* \return 0 - ошибка, номер задачи-job неверный
+*/
+uint8_t mRTOS_SetJobPeriod(uint8_t JobNumber, uint16_t Period) {
+    if(JobNumber >= mRTOS_InitJobsCounter) // если номер задачи-job неверный, то
+        return 0;                        // выход с кодом ошибки
+    mRTOS_PORT_CRITICAL() {
+        mRTOS_JobPeriod[JobNumber] = Period;
+        mRTOS_JobCounter[JobNumber] = Period;
+    }
+    return 1;                            // выход с кодом успешного выполнения
+}
+#endif
+
+#if mRTOS_USE_TASK_BUDGET
+/**
+* Функция задания бюджета времени выполнения задачи без передачи управления
+* планировщику; счётчик превышений и наибольшая длительность сбрасываются
+* входные параметры:
+* \param TaskNumber - номер задачи;
+* \param Budget - бюджет в тиках (0 - не задан).
+* возвращает:
+* \return 1 - бюджет задан
+* \return 0 - ошибка, номер задачи неверный
+*/
+uint8_t mRTOS_SetTaskBudget(uint8_t TaskNumber, uint16_t Budget) {
+    if(TaskNumber >= mRTOS_MAX_TASKS)    // если номер задачи неверный, то
+        return 0;                        // выход с кодом ошибки
+    mRTOS_PORT_CRITICAL() {
+        mRTOS_TaskBudget[TaskNumber] = Budget;
+        mRTOS_TaskRunMax[TaskNumber] = 0;
+        mRTOS_TaskOverruns[TaskNumber] = 0;
+    }
+    return 1;                            // выход с кодом успешного выполнения
+}
+
+/**
+* Функция чтения наибольшей длительности выполнения задачи без передачи
+* управления планировщику
+* входной параметр:
+* \param TaskNumber - номер задачи
+* возвращает:
+* \return длительность в тиках
+* \return 0 - номер задачи неверный
+*/
+uint16_t mRTOS_GetTaskRunMax(uint8_t TaskNumber) {
+    uint16_t temp;
+    if(TaskNumber >= mRTOS_MAX_TASKS)    // если номер задачи неверный, то
+        return 0;                        // выход с кодом ошибки
+    mRTOS_PORT_CRITICAL() {
+        temp = mRTOS_TaskRunMax[TaskNumber];
+    }
+    return temp;
+}
+
+/**
+* Функция чтения количества превышений бюджета задачей
+* входной параметр:
+* \param TaskNumber - номер задачи
+* возвращает:
+* \return количество превышений (до 255)
+* \return 0 - номер задачи неверный
+*/
+uint8_t mRTOS_GetTaskOverruns(uint8_t TaskNumber) {
+    if(TaskNumber >= mRTOS_MAX_TASKS)    // если номер задачи неверный, то
+        return 0;                        // выход с кодом ошибки
+    return mRTOS_TaskOverruns[TaskNumber];
+}
+#endif
+
+#if mRTOS_USE_STACK_SAVE
+/**
+* Функция чтения наибольшей длины сегмента стека задачи, сохранявшегося при
+* переключении задач (для подбора mRTOS_STACK_SAVE_SIZE)
+* входной параметр:
+* \param TaskNumber - номер задачи
+* возвращает:
+* \return длина сегмента в байтах (255 - переполнение области сохранения)
+* \return 0 - номер задачи неверный
+*/
+uint8_t mRTOS_GetStackSaveMax(uint8_t TaskNumber) {
+    if(TaskNumber >= mRTOS_MAX_TASKS)    // если номер задачи неверный, то
+        return 0;                        // выход с кодом ошибки
+    return mRTOS_StackSaveMax[TaskNumber];
+}
+#endif
+
+#if mRTOS_USE_STACK_MONITOR
+/**
+* Функция чтения наибольшей глубины стека задачи: в вытесняющем режиме - по
+* окрашиванию стека задачи, в кооперативном - по отметкам указателя стека
+* (от RAMEND, включая кадр функции main)
+* входной параметр:
+* \param TaskNumber - номер задачи
+* возвращает:
+* \return глубина стека в байтах
+* \return 0 - номер задачи неверный (или задача не выполнялась)
+*/
+uint16_t mRTOS_GetTaskStackUsed(uint8_t TaskNumber) {
+    uint16_t temp;
+    if(TaskNumber >= mRTOS_MAX_TASKS)    // если номер задачи неверный, то
+        return 0;                        // выход с кодом ошибки
+#if mRTOS_USE_PREEMPTIVE
+    temp = 0;
+    while((temp < mRTOS_TASK_STACK_SIZE) && (mRTOS_Stacks[TaskNumber][temp] == mRTOS_STACK_PAINT)) // пропустить не использованные байты
+        temp++;
+    return mRTOS_TASK_STACK_SIZE - temp;
+#else
+    mRTOS_PORT_CRITICAL() {
+        temp = mRTOS_StackTaskMin[TaskNumber];
+    }
+    return RAMEND - temp;
+#endif
+}
+
+#if !mRTOS_USE_PREEMPTIVE
+/**
+* Функция чтения наибольшей глубины стека в обработчике системного тика
+* (от RAMEND, включая стек прерванной задачи)
+* возвращает:
+* \return глубина стека в байтах
+*/
+uint16_t mRTOS_GetIsrStackUsed(void) {
+    uint16_t temp;
+    mRTOS_PORT_CRITICAL() {
+        temp = mRTOS_StackIsrMin;
+    }
+    return RAMEND - temp;
+}
+#endif
+#endif
+
+#if mRTOS_USE_TRACE
+/**
+* Функция чтения системного времени для трассировки (вызывается при
+* запрещённых прерываниях)
+* входной параметр:
+* \param CountsPtr - указатель на переменную для отсчётов таймера от начала тика
+* возвращает:
+* \return системное время в тиках
+*/
+uint32_t mRTOS_GetTraceTime(uint8_t* CountsPtr) {
+    return mRTOS_SystemTime + mRTOS_PendingTicks(CountsPtr);
+}
+#endif
+
 /**
 * Функция установки значения системного времени в тиках
 * входной параметр:
 * \param Time - устанавливаемое значение системного времени в тиках
 */
 void mRTOS_SetSystemTime(uint32_t Time) {
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    mRTOS_PORT_CRITICAL() {
         mRTOS_SystemTime = Time;           // установить значение системного времени
+#if mRTOS_USE_TIME64
+        mRTOS_SystemTimeHigh = 0;          // сбросить старшую часть времени
+#endif
+        mRTOS_TimeSequence++;              // системное время изменено
     }
 }
 
 /**
-* Функция чтения текущего значения системного времени в тиках
+* Функция чтения текущего значения системного времени в тиках: прерывания
+* не запрещаются, значение перечитывается, если во время чтения произошёл
+* системный тик
 * возвращает:
 * \return текущее значение системного времени в тиках
 */
 uint32_t mRTOS_GetSystemTime(void) {
     uint32_t temp;
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    uint8_t sequence;
+    do {
+        sequence = mRTOS_TimeSequence;
         temp = mRTOS_SystemTime;           // прочитать значение системного времени
-    }
+#if mRTOS_USE_TICKLESS_IDLE
+        if(mRTOS_TicklessLength)           // если задача Idle в режиме сна (чтение из прерывания), то
+            temp += mRTOS_TicklessCounts(mRTOS_TicklessElapsed()) / mRTOS_TICK_COUNTS; // учесть тики, прошедшие с начала сна
+#endif
+    } while(sequence != mRTOS_TimeSequence); // повторить, если системное время изменилось во время чтения
+    return temp;
+}
+
+#if mRTOS_USE_TIME64
+/**
+* Функция чтения 64-разрядного системного времени в тиках (без запрета
+* прерываний)
+* возвращает:
+* \return текущее значение системного времени в тиках
+*/
+uint64_t mRTOS_GetSystemTime64(void) {
+    uint64_t temp;
+    uint8_t sequence;
+    do {
+        sequence = mRTOS_TimeSequence;
+        temp = ((uint64_t)mRTOS_SystemTimeHigh << 32) | mRTOS_SystemTime;
+#if mRTOS_USE_TICKLESS_IDLE
+        if(mRTOS_TicklessLength)           // если задача Idle в режиме сна (чтение из прерывания), то
+            temp += mRTOS_TicklessCounts(mRTOS_TicklessElapsed()) / mRTOS_TICK_COUNTS; // учесть тики, прошедшие с начала сна
+#endif
+    } while(sequence != mRTOS_TimeSequence); // повторить, если системное время изменилось во время чтения
     return temp;
 }
+#endif
+
+#if mRTOS_USE_HIRES_TIME
+/**
+* Функция чтения системного времени в микросекундах: системное время
+* дополняется отсчётами таймера в текущем тике, прерывание тика, ожидающее
+* обработки (чтение при запрещённых прерываниях), учитывается как истёкший
+* тик. Прерывания не запрещаются, значение перечитывается, если во время
+* чтения произошёл системный тик.
+* возвращает:
+* \return время в микросекундах (разрешение - отсчёт таймера системного тика)
+*/
+mRTOS_Micros mRTOS_GetTimeMicros(void) {
+    mRTOS_Micros ticks;
+    uint8_t sequence, counts;
+    do {
+        sequence = mRTOS_TimeSequence;
+#if mRTOS_USE_TIME64
+        ticks = ((uint64_t)mRTOS_SystemTimeHigh << 32) | mRTOS_SystemTime;
+#else
+        ticks = mRTOS_SystemTime;
+#endif
+        ticks += mRTOS_PendingTicks(&counts); // тики, ещё не учтённые обработчиком, и отсчёты таймера текущего тика
+    } while(sequence != mRTOS_TimeSequence); // повторить, если системное время изменилось во время чтения
+    return ticks * mRTOS_TICK_US + (((uint32_t)counts * mRTOS_COUNT_US_Q8) >> 8);
+}
+#endif
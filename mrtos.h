@@ -25,10 +25,81 @@
 #ifndef mRTOS_H_INCLUDED
 #define mRTOS_H_INCLUDED
 
-enum TaskState{ NOINIT, ACTIVE, SUSPEND, WAIT, SEMAPHORE, STOP }; // состояние (статус) задачи
+// Параметры конфигурации mRTOS (mRTOS_USE_xxx и их значения) могут быть заданы при сборке (-D), например
+// при сборке тестов производительности (bench/) в нескольких конфигурациях.
+
+// Режим ядра mRTOS:
+// 0 - кооперативный (по умолчанию): общий стек, контекст задачи - адрес возврата и SREG; локальные
+//     переменные и регистры задачи не сохраняются между вызовами функций ожидания и диспетчера.
+//     Переключение задачи ~40 тактов (сохранение адреса возврата 13 тактов, переход на задачу ~27 тактов)
+//     без учёта выбора задачи планировщиком. Время реакции в худшем случае - наибольший интервал
+//     выполнения любой задачи между вызовами функций ожидания или диспетчера плюс время планировщика.
+// 1 - вытесняющий: у каждой задачи свой стек, при переключении сохраняются все 32 регистра и SREG.
+//     Обработчик системного тика вытесняет текущую задачу, если в этом тике стала готовой (задержка Wait
+//     истекла, задача разбужена событием, семафором, мьютексом или переведена в Active) задача с более
+//     высоким приоритетом, чем у текущей (уровнем приоритета в ядре с битовыми картами, более ранним
+//     сроком при политике EDF), или выполняется задача Idle; задачи с равным приоритетом сменяются по
+//     истечении кванта mRTOS_TIME_SLICE.
+//     Сохранение контекста 79 тактов (в обработчике тика ещё 7 тактов на установку флага I в сохранённом
+//     SREG), восстановление 77 тактов + ret/reti 4 такта, итого ~160 тактов (10 мкс при 16 МГц) без учёта
+//     выбора задачи планировщиком. Время реакции в худшем случае - один системный тик (пробуждение
+//     из прерывания обрабатывается в ближайшем тике) плюс наибольший участок с запрещёнными прерываниями
+//     и время переключения.
+// Значения тактов и времени реакции - оценки подсчётом команд ассемблерных вставок ядра, а не
+// результаты измерений (на AVR не измерялись).
+#ifndef mRTOS_USE_PREEMPTIVE
+#define mRTOS_USE_PREEMPTIVE  0
+#endif
+#ifndef mRTOS_TASK_STACK_SIZE
+#define mRTOS_TASK_STACK_SIZE 96  // размер стека каждой задачи в байтах в вытесняющем режиме (кадр контекста - 35 байт)
+#endif
+#ifndef mRTOS_TIME_SLICE
+#define mRTOS_TIME_SLICE      0   // квант времени в тиках, по истечении которого вызывается планировщик в вытесняющем режиме (0 - без квантования)
+#endif
+
+// Сохранение сегмента стека в кооперативном режиме: функции ожидания и диспетчера можно вызывать
+// на любой глубине вложенности вызовов задачи. При переключении задачи сегмент общего стека от базы
+// задач до указателя стека (адреса возврата, кадры функций и регистры r2...r17, r28, r29, SREG - 19 байт)
+// копируется в область сохранения задачи и восстанавливается при возврате в задачу. Копирование
+// выполняется при запрещённых прерываниях (~7 тактов на байт в каждую сторону) и пропускается,
+// если планировщик выбрал ту же задачу. Ниже базы задач должно быть свободно mRTOS_STACK_SAVE_SIZE байт
+// плюс стек планировщика. Переполнение области сохранения обнаруживается до копирования, при этом
+// выполняется mRTOS_STACK_SAVE_OVERFLOW(n) (по умолчанию - останов; сброс сторожевым таймером),
+// действие не должно возвращать управление.
+#ifndef mRTOS_USE_STACK_SAVE
+#define mRTOS_USE_STACK_SAVE   0
+#endif
+#ifndef mRTOS_STACK_SAVE_SIZE
+#define mRTOS_STACK_SAVE_SIZE  48       // размер области сохранения стека каждой задачи в байтах (21...255, кадр запуска задачи - 21 байт)
+#endif
+#ifndef mRTOS_STACK_SAVE_OVERFLOW
+#define mRTOS_STACK_SAVE_OVERFLOW(n) for(;;) // действие при переполнении области сохранения стека задачи под номером n
+#endif
+
+// Статическая таблица задач и событий: задачи и события описываются на этапе компиляции таблицами
+// mRTOS_TASK_TABLE и mRTOS_EVENT_TABLE в файле приложения mrtos_config.h (включается из mrtos.h),
+// количество задач и событий вычисляется по таблицам.
+// Постоянные поля (точка входа, исходный приоритет и состояние задачи, задача, за которой закреплено
+// событие) размещаются во flash (PROGMEM), задачи создаются функцией mRTOS_Init, события разрешены
+// сразу после mRTOS_Init и не требуют вызова mRTOS_InitEvent.
+#ifndef mRTOS_USE_STATIC_TASKS
+#define mRTOS_USE_STATIC_TASKS 0
+#endif
+
+#if mRTOS_USE_PREEMPTIVE && mRTOS_USE_STACK_SAVE
+#error "mRTOS: stack save is a cooperative mode option, it can not be used with preemptive mode"
+#endif
+#if mRTOS_USE_STACK_SAVE && ((mRTOS_STACK_SAVE_SIZE < 21) || (mRTOS_STACK_SAVE_SIZE > 255))
+#error "mRTOS: mRTOS_STACK_SAVE_SIZE must be 21...255"
+#endif
+
+enum TaskState{ NOINIT, ACTIVE, SUSPEND, WAIT, SEMAPHORE, STOP }; // состояние (статус) задачи (Semaphore - ожидание события или объекта синхронизации)
 
 // --- структура контекста задачи ---
 struct TaskContext {
+#if mRTOS_USE_PREEMPTIVE
+    uint16_t StackPointer;       // указатель стека задачи (вытесняющий режим, должен быть первым полем)
+#endif
     uint16_t TaskAddress;        // адреса точки входа в задачу
     uint8_t  TaskCpuState;       // состояние регистра SREG задачи
 };
@@ -38,31 +109,432 @@ struct TCB {
     CurrentPriority;             // текущий приоритет задачи
     struct TaskContext Context;  // текущий контекст задачи
     enum TaskState State;        // текущее состояние задачи
-    uint16_t Delay;              // время задержки в тиках в состоянии задачи Wait
+    uint16_t Delay;              // время задержки в тиках в состоянии задачи Wait (обнуляется по истечении задержки)
 };
 // --- структура блока контроля события (Event Control Block) ---
 struct ECB {
-    uint8_t TaskNumber,          // номер задачи закрепленной за событием
-    FlagControlEvent,            // флаг установлен - событие разрешено (ожидание события)
+#if !mRTOS_USE_STATIC_TASKS
+    uint8_t TaskNumber;          // номер задачи закрепленной за событием (в статической таблице - во flash)
+#endif
+    uint8_t FlagControlEvent,    // флаг установлен - событие разрешено (ожидание события)
     FlagEvent;                   // флаг установлен - событие произошло
 };
+// --- структура счётного семафора ---
+struct Semaphore {
+    uint8_t Count,               // значение счётчика семафора
+    WaitList;                    // номер первой задачи списка ожидания (список упорядочен по приоритету)
+};
+// --- структура мьютекса (с наследованием приоритета) ---
+// Наследование приоритета не транзитивно: владелец получает приоритет задач, ожидающих его мьютекс, но
+// не передаёт его дальше. Поэтому вложенный захват не поддерживается: задача, владеющая мьютексом, не
+// может захватить другой (или тот же) мьютекс - mRTOS_TryLockMutex возвращает 0, mRTOS_LockMutex
+// выполняет действие mRTOS_MUTEX_NESTED и возвращает управление без захвата. Если владелец мьютекса
+// ожидает семафор или группу событий, его место в их списке ожидания определяется приоритетом на момент
+// начала ожидания и при наследовании приоритета не изменяется.
+#ifndef mRTOS_MUTEX_NESTED
+#define mRTOS_MUTEX_NESTED(n) for(;;)   // действие при попытке вложенного захвата мьютекса задачей под номером n
+#endif
+struct Mutex {
+    uint8_t Owner,               // номер задачи-владельца мьютекса (0xFF - мьютекс свободен)
+    OwnerPriority,               // приоритет задачи-владельца на момент захвата мьютекса
+    WaitList;                    // номер первой задачи списка ожидания (список упорядочен по приоритету)
+};
 
 // --- Макросы mRTOS ---
 
+#if mRTOS_USE_STATIC_TASKS
+#include "mrtos_config.h"                                // таблицы задач и событий приложения
+#if !defined(mRTOS_TASK_TABLE) || !defined(mRTOS_EVENT_TABLE)
+#error "mRTOS: static tasks need mRTOS_TASK_TABLE and mRTOS_EVENT_TABLE in mrtos_config.h"
+#endif
+
+#define mRTOS_TABLE_COUNT(...)  +1                       // подсчёт строк таблицы задач или событий
+#define mRTOS_TASK_ID(Task)     mRTOS_TASK_ID_##Task     // номер задачи из таблицы задач
+#define mRTOS_EVENT_ID(Event)   mRTOS_EVENT_ID_##Event   // номер события из таблицы событий
+#define mRTOS_TASK_ENUM(Task, Priority, State) mRTOS_TASK_ID_##Task,
+#define mRTOS_EVENT_ENUM(Event, Task)          mRTOS_EVENT_ID_##Event,
+enum { mRTOS_TASK_ID_mRTOS_Idle, mRTOS_TASK_TABLE(mRTOS_TASK_ENUM) };
+enum { mRTOS_EVENT_TABLE(mRTOS_EVENT_ENUM) mRTOS_EVENT_ID_END };
+
+#define mRTOS_APPLICATION_TASKS (0 mRTOS_TASK_TABLE(mRTOS_TABLE_COUNT))  // количество пользовательских задач в приложении
+#define mRTOS_MAX_EVENTS        (0 mRTOS_EVENT_TABLE(mRTOS_TABLE_COUNT)) // количество событий в приложении
+#else
+#ifndef mRTOS_APPLICATION_TASKS
 #define mRTOS_APPLICATION_TASKS 1                        // количество пользовательских задач в приложении
+#endif
+#ifndef mRTOS_MAX_EVENTS
 #define mRTOS_MAX_EVENTS        1                        // количество событий в приложении
+#endif
+#endif
 #define mRTOS_MAX_TASKS    (mRTOS_APPLICATION_TASKS + 1) // общее количество задач в приложении (задача Idle создаётся всегда)
 
-// Для работы RTOS используется таймер T0 - задает времменой интервал - системный тик
-// Ktcnt0 = 256 - T / (Tclk * Pscl), где Tclk = 1 / Fxtal, Pscl - значение предделителя T0
-// T = 1 мсек.  при Xtal = 8 МГц, Tclk = 0.125 мксек, Pscl = 64
-#define mRTOS_SYSTEM_TIMER_PRESCALER_VALUE 3    // Ktcnt0 = 256 - 1000 / (0.125 * 64) = 131; T = (256 - Ktcnt0) * (Tclk * Pscl) = (256 - 131) * (0.125 * 64) = 1.000 мсек.
-#define mRTOS_SYSTEM_TIMER_RELOAD_VALUE    131  // значение перезагрузки системного таймера для обеспечения заданного интервала системного тика
+// Выбор ядра планировщика задач:
+// 0 - сканирование таблицы задач с кредитами текущего приоритета (CurrentPriority);
+// 1 - битовые карты готовности по уровням приоритета (время выбора задачи не зависит от количества задач).
+//     Уровень приоритета задачи = Priority / 32 (8 уровней), внутри уровня задачи выполняются по кругу,
+//     задача с истёкшей задержкой Wait получает управление вне очереди. Не более 16 задач.
+#ifndef mRTOS_USE_BITMAP_SCHEDULER
+#define mRTOS_USE_BITMAP_SCHEDULER 0
+#endif
+
+#if mRTOS_USE_BITMAP_SCHEDULER && (mRTOS_MAX_TASKS > 16)
+#error "mRTOS: bitmap scheduler supports up to 16 tasks"
+#endif
+
+// Политика выбора задачи при сканировании таблицы задач (mRTOS_USE_BITMAP_SCHEDULER = 0):
+// mRTOS_POLICY_CREDIT   - кредиты текущего приоритета (CurrentPriority): кредиты всех задач восстанавливаются,
+//                         когда кредит одной из них исчерпан, задача с истёкшей задержкой Wait получает
+//                         управление вне очереди;
+// mRTOS_POLICY_PRIORITY - фиксированные приоритеты: выбирается готовая задача с наибольшим приоритетом Priority,
+//                         задачи с равным приоритетом выполняются по кругу;
+// mRTOS_POLICY_EDF      - наиболее ранний срок: выбирается готовая периодическая задача с наиболее ранним сроком
+//                         (момент следующего выпуска, mRTOS_SetTaskPeriod), задачи без срока выполняются после
+//                         них по фиксированным приоритетам (требуется mRTOS_USE_PERIODIC_TASKS).
+// При политиках PRIORITY и EDF задача Idle выбирается, только если других готовых задач нет.
+// Проверка планируемости набора задач - tools/mrtos_sched.py.
+#define mRTOS_POLICY_CREDIT    0
+#define mRTOS_POLICY_PRIORITY  1
+#define mRTOS_POLICY_EDF       2
+#ifndef mRTOS_SCHEDULING_POLICY
+#define mRTOS_SCHEDULING_POLICY mRTOS_POLICY_CREDIT
+#endif
+
+#if mRTOS_USE_BITMAP_SCHEDULER && (mRTOS_SCHEDULING_POLICY != mRTOS_POLICY_CREDIT)
+#error "mRTOS: scheduling policies require mRTOS_USE_BITMAP_SCHEDULER = 0"
+#endif
+
+// Размещение блоков контроля задач:
+// 0 - массив структур TCB mRTOS_Tasks[] (volatile);
+// 1 - упакованные отдельные массивы состояний, текущих приоритетов (кредитов), приоритетов и контекстов
+//     задач без volatile (доступ в критических секциях и обработчиках прерываний). Состояние задачи
+//     занимает 1 байт: задача в состоянии Wait с не истёкшей задержкой имеет состояние
+//     WAIT | mRTOS_STATE_DELAYED, поэтому поле Delay не хранится (оставшаяся задержка - в списке задержек).
+//     Экономия 2 байта ОЗУ на задачу (3 байта без -fshort-enums), сканирование задач планировщиком
+//     выполняется последовательным перебором массивов вместо индексного доступа к структурам.
+#ifndef mRTOS_USE_PACKED_TCB
+#define mRTOS_USE_PACKED_TCB 0
+#endif
+
+// Системный тик: частота mRTOS_TICK_HZ, предделитель и длительность тика в отсчётах таймера вычисляются на
+// этапе компиляции из F_CPU. Выбирается наименьший предделитель, при котором тик не длиннее 256 отсчётов
+// (отсчёты от начала тика помещаются в байт), длительность тика округляется до целого числа отсчётов;
+// если отклонение частоты тика превышает mRTOS_TICK_TOLERANCE_PPM, сборка прерывается.
+// Таймер системного тика mRTOS_SYSTEM_TIMER:
+// 0 - T0, прерывание по переполнению: счётчик перезагружается в обработчике прибавлением значения
+//     перезагрузки, поэтому задержка входа в обработчик не удлиняет тик (кроме случая, когда счётчик
+//     изменяется во время перезагрузки - при предделителе 1 и 8);
+// 1 - T1 в режиме CTC (сравнение с OCR1A), 2 - T2 в режиме CTC (сравнение с OCR2): период тика задаётся
+//     аппаратно, обработчик не обращается к таймеру. Режим без системного тика (mRTOS_USE_TICKLESS_IDLE)
+//     поддерживается с таймерами T0 и T1.
+// Таймер запускается и его прерывание разрешается функцией mRTOS_Init.
+#ifndef F_CPU
+#error "mRTOS: F_CPU must be defined"
+#endif
+#ifndef mRTOS_TICK_HZ
+#define mRTOS_TICK_HZ            1000   // частота системного тика в Гц
+#endif
+#ifndef mRTOS_TICK_TOLERANCE_PPM
+#define mRTOS_TICK_TOLERANCE_PPM 1000   // допустимое отклонение частоты тика в миллионных долях
+#endif
+#ifndef mRTOS_SYSTEM_TIMER
+#define mRTOS_SYSTEM_TIMER       0      // таймер системного тика (0 - T0, 1 - T1, 2 - T2)
+#endif
+
+#define mRTOS_TICK_DIV(p)  ((F_CPU + (p) * mRTOS_TICK_HZ / 2) / ((p) * mRTOS_TICK_HZ)) // длительность тика в отсчётах при предделителе p
+#if mRTOS_TICK_DIV(1) <= 256
+#define mRTOS_SYSTEM_TIMER_PRESCALER_RATIO 1
+#define mRTOS_SYSTEM_TIMER_PRESCALER_VALUE 1
+#elif mRTOS_TICK_DIV(8) <= 256
+#define mRTOS_SYSTEM_TIMER_PRESCALER_RATIO 8
+#define mRTOS_SYSTEM_TIMER_PRESCALER_VALUE 2
+#elif (mRTOS_SYSTEM_TIMER == 2) && (mRTOS_TICK_DIV(32) <= 256)
+#define mRTOS_SYSTEM_TIMER_PRESCALER_RATIO 32
+#define mRTOS_SYSTEM_TIMER_PRESCALER_VALUE 3
+#elif mRTOS_TICK_DIV(64) <= 256
+#define mRTOS_SYSTEM_TIMER_PRESCALER_RATIO 64
+#define mRTOS_SYSTEM_TIMER_PRESCALER_VALUE ((mRTOS_SYSTEM_TIMER == 2) ? 4 : 3)
+#elif (mRTOS_SYSTEM_TIMER == 2) && (mRTOS_TICK_DIV(128) <= 256)
+#define mRTOS_SYSTEM_TIMER_PRESCALER_RATIO 128
+#define mRTOS_SYSTEM_TIMER_PRESCALER_VALUE 5
+#elif mRTOS_TICK_DIV(256) <= 256
+#define mRTOS_SYSTEM_TIMER_PRESCALER_RATIO 256
+#define mRTOS_SYSTEM_TIMER_PRESCALER_VALUE ((mRTOS_SYSTEM_TIMER == 2) ? 6 : 4)
+#elif mRTOS_TICK_DIV(1024) <= 256
+#define mRTOS_SYSTEM_TIMER_PRESCALER_RATIO 1024
+#define mRTOS_SYSTEM_TIMER_PRESCALER_VALUE ((mRTOS_SYSTEM_TIMER == 2) ? 7 : 5)
+#else
+#error "mRTOS: mRTOS_TICK_HZ is too low for the system timer"
+#define mRTOS_SYSTEM_TIMER_PRESCALER_RATIO 1024
+#define mRTOS_SYSTEM_TIMER_PRESCALER_VALUE 5
+#endif
+#define mRTOS_TICK_COUNTS  mRTOS_TICK_DIV(mRTOS_SYSTEM_TIMER_PRESCALER_RATIO) // длительность системного тика в отсчётах таймера
+#define mRTOS_SYSTEM_TIMER_RELOAD_VALUE (256 - mRTOS_TICK_COUNTS)          // значение перезагрузки T0 (счёт до переполнения)
+
+#if (mRTOS_SYSTEM_TIMER < 0) || (mRTOS_SYSTEM_TIMER > 2)
+#error "mRTOS: mRTOS_SYSTEM_TIMER must be 0 (T0), 1 (T1) or 2 (T2)"
+#endif
+#if mRTOS_TICK_COUNTS < 16
+#error "mRTOS: mRTOS_TICK_HZ is too high for F_CPU"
+#elif ((F_CPU > mRTOS_TICK_COUNTS * mRTOS_SYSTEM_TIMER_PRESCALER_RATIO * mRTOS_TICK_HZ) ? \
+     (F_CPU - mRTOS_TICK_COUNTS * mRTOS_SYSTEM_TIMER_PRESCALER_RATIO * mRTOS_TICK_HZ) : \
+     (mRTOS_TICK_COUNTS * mRTOS_SYSTEM_TIMER_PRESCALER_RATIO * mRTOS_TICK_HZ - F_CPU)) * 1000000 > mRTOS_TICK_TOLERANCE_PPM * F_CPU
+#error "mRTOS: mRTOS_TICK_HZ can not be reached within mRTOS_TICK_TOLERANCE_PPM for F_CPU"
+#endif
+
+// Режим без системного тика (tickless) в задаче Idle: если готова только задача Idle, системный таймер
+// перепрограммируется на интервал до ближайшего пробуждения задачи и микроконтроллер переводится в режим сна.
+// Таймеры T0 и T1 тактируются только в режиме сна Idle, поэтому другие режимы сна здесь не применимы.
+// T0 (mRTOS_SYSTEM_TIMER = 0): на время сна T0 переключается на предделитель clk/1024, поэтому сон не длиннее
+//     255 отсчётов clk/1024 (при F_CPU = 16 МГц и тике 1 кГц - около 16 тиков). При запуске и завершении сна
+//     сбрасывается предделитель (SFIOR: PSR10), общий для T0 и T1: если приложение использует T1, его счёт
+//     сдвигается на время до одного периода предделителя T1 при каждом засыпании и пробуждении.
+// T1 (mRTOS_SYSTEM_TIMER = 1): на время сна продлевается период сравнения OCR1A, предделитель не изменяется
+//     и не сбрасывается, фаза тика сохраняется; сон не длиннее 65535 отсчётов T1 (при F_CPU = 16 МГц и тике
+//     1 кГц - 261 тик). Если T1 свободен, для режима без системного тика следует выбирать его.
+#ifndef mRTOS_USE_TICKLESS_IDLE
+#define mRTOS_USE_TICKLESS_IDLE 0
+#endif
+#ifndef mRTOS_IDLE_SLEEP_MODE
+#define mRTOS_IDLE_SLEEP_MODE   SLEEP_MODE_IDLE  // режим сна задачи Idle
+#endif
+#define mRTOS_TICKLESS_TIMER_PRESCALER_VALUE 5   // значение предделителя T0 на время сна (clk/1024)
+#define mRTOS_TICKLESS_TIMER_PRESCALER_RATIO (1024 / mRTOS_SYSTEM_TIMER_PRESCALER_RATIO) // отношение предделителя T0 на время сна к основному
+
+#if mRTOS_USE_TICKLESS_IDLE && (mRTOS_SYSTEM_TIMER == 2)
+#error "mRTOS: tickless idle requires the T0 or T1 system timer (mRTOS_SYSTEM_TIMER = 0 or 1)"
+#endif
+
+// Время высокого разрешения: mRTOS_GetTimeMicros возвращает время в микросекундах, складывая системное
+// время и отсчёты таймера в текущем тике (с учётом тика, ожидающего обработки). Чтение системного
+// времени не запрещает прерывания: значение перечитывается, если во время чтения изменился счётчик
+// последовательности, увеличиваемый системным тиком. Длительность тика должна составлять целое число
+// микросекунд. 32-разрядное время в микросекундах переполняется через ~71.6 мин.
+#ifndef mRTOS_USE_HIRES_TIME
+#define mRTOS_USE_HIRES_TIME 0
+#endif
+// 64-разрядное системное время: старшая часть счётчика тиков увеличивается при переполнении
+// mRTOS_SystemTime (через ~49.7 сут при тике 1 мс), функция mRTOS_GetSystemTime64 возвращает 64-разрядное
+// время в тиках, mRTOS_GetTimeMicros - 64-разрядное время в микросекундах (4 байта ОЗУ).
+#ifndef mRTOS_USE_TIME64
+#define mRTOS_USE_TIME64     0
+#endif
+
+#if mRTOS_USE_HIRES_TIME
+#define mRTOS_TICK_US  ((uint32_t)mRTOS_TICK_COUNTS * mRTOS_SYSTEM_TIMER_PRESCALER_RATIO * 1000000UL / F_CPU) // длительность тика в микросекундах
+#define mRTOS_COUNT_US_Q8  ((uint32_t)(mRTOS_SYSTEM_TIMER_PRESCALER_RATIO * 256000000ULL / F_CPU)) // длительность отсчёта таймера в 1/256 мкс
+#if (mRTOS_TICK_COUNTS * mRTOS_SYSTEM_TIMER_PRESCALER_RATIO * 1000000ULL) % F_CPU
+#error "mRTOS: high resolution time requires a system tick of a whole number of microseconds"
+#endif
+#if mRTOS_USE_TIME64
+typedef uint64_t mRTOS_Micros;      // время в микросекундах
+#else
+typedef uint32_t mRTOS_Micros;      // время в микросекундах
+#endif
+#endif
+
+// Трассировка переключений задач (mrtos_trace.h): буфер записей переключений с метками времени,
+// время выполнения и количество переключений задач, загрузка процессора. При значении 0 вызовы
+// трассировки в ядре не компилируются.
+#ifndef mRTOS_USE_TRACE
+#define mRTOS_USE_TRACE  0
+#endif
+#ifndef mRTOS_TRACE_SIZE
+#define mRTOS_TRACE_SIZE 32   // количество записей буфера трассировки (степень двойки, не более 128; запись - 5 байт)
+#endif
+
+// Периодические задачи: задача, для которой задан период функцией mRTOS_SetTaskPeriod, ожидает
+// следующего выпуска макросом mRTOS_TASK_WAIT_PERIOD; моменты выпуска отсчитываются от времени
+// задания периода (без накопления ошибки), пропущенные выпуски подсчитываются (7 байт ОЗУ на задачу).
+#ifndef mRTOS_USE_PERIODIC_TASKS
+#define mRTOS_USE_PERIODIC_TASKS 0
+#endif
+
+#if (mRTOS_SCHEDULING_POLICY == mRTOS_POLICY_EDF) && !mRTOS_USE_PERIODIC_TASKS
+#error "mRTOS: EDF scheduling policy requires mRTOS_USE_PERIODIC_TASKS"
+#endif
+
+// Задачи выполнения до завершения (jobs): функция задачи вызывается планировщиком как обычная функция и
+// возвращает ему управление, контекст (struct TaskContext) не сохраняется. Задача выполняется после
+// запроса функцией mRTOS_PostJob (из задач и прерываний, например при событии) или периодически по
+// системному тику (mRTOS_SetJobPeriod). Планировщик выполняет готовые задачи-jobs, приоритет которых не
+// ниже приоритета выбранной обычной задачи (при выбранной задаче Idle - любые), в порядке приоритета,
+// перед передачей ей управления. Функция задачи-job не должна ожидать и вызывать диспетчер, обращаться
+// к текущей задаче (mRTOS_SetTaskStatus и т. п.) и выполняется на стеке планировщика. Только
+// кооперативный режим без сохранения стека (7 байт ОЗУ на задачу-job).
+#ifndef mRTOS_USE_JOBS
+#define mRTOS_USE_JOBS 0
+#endif
+#ifndef mRTOS_MAX_JOBS
+#define mRTOS_MAX_JOBS 4    // количество задач выполнения до завершения (не более 8)
+#endif
+
+#if mRTOS_USE_JOBS && (mRTOS_USE_PREEMPTIVE || mRTOS_USE_STACK_SAVE)
+#error "mRTOS: run-to-completion jobs require the cooperative kernel without stack save"
+#endif
+#if mRTOS_USE_JOBS && ((mRTOS_MAX_JOBS < 1) || (mRTOS_MAX_JOBS > 8))
+#error "mRTOS: mRTOS_MAX_JOBS must be 1...8"
+#endif
+
+// Бюджет времени выполнения задач: системный тик отсчитывает длительность выполнения текущей задачи
+// без передачи управления планировщику (с точностью до тика) и отмечает наибольшую длительность для
+// каждой задачи. Если для задачи задан бюджет функцией mRTOS_SetTaskBudget и длительность его
+// превысила, то увеличивается счётчик превышений задачи и выполняется mRTOS_TASK_OVERRUN(n) в
+// обработчике прерывания при запрещённых прерываниях (по умолчанию - ничего; для сброса
+// сторожевым таймером: do { wdt_enable(WDTO_15MS); for(;;); } while(0)). 5 байт ОЗУ на задачу.
+#ifndef mRTOS_USE_TASK_BUDGET
+#define mRTOS_USE_TASK_BUDGET 0
+#endif
+#ifndef mRTOS_TASK_OVERRUN
+#define mRTOS_TASK_OVERRUN(n)        // действие при превышении бюджета задачей под номером n
+#endif
+
+// Программные таймеры (mrtos_timer.h): функции однократных и периодических таймеров выполняются
+// задачей mRTOS_TimerService, которую создаёт приложение; системный тик уменьшает задержку только
+// первого таймера списка.
+#ifndef mRTOS_USE_TIMERS
+#define mRTOS_USE_TIMERS 0
+#endif
+
+// Очередь отложенной обработки прерываний (mrtos_defer.h): обработчик прерывания помещает в очередь функцию
+// с аргументом, функции выполняются по порядку задачей mRTOS_DeferService, которую создаёт приложение
+// (с наибольшим приоритетом); после mRTOS_DEFER_BATCH функций задача вызывает диспетчер.
+#ifndef mRTOS_USE_DEFER
+#define mRTOS_USE_DEFER        0
+#endif
+#ifndef mRTOS_DEFER_QUEUE_SIZE
+#define mRTOS_DEFER_QUEUE_SIZE 8    // размер очереди в элементах (степень двойки, не более 128; элемент - 4 байта)
+#endif
+#ifndef mRTOS_DEFER_BATCH
+#define mRTOS_DEFER_BATCH      4    // количество функций, выполняемых задачей обслуживания между вызовами диспетчера
+#endif
+
+// Контроль использования стека и ОЗУ (mrtos_stack.h): функция mRTOS_Init окрашивает свободную область стека
+// (от конца .bss до указателя стека) значением mRTOS_STACK_PAINT, наибольшая глубина стека определяется по
+// границе окрашенной области. Для каждой задачи отмечается наибольшая глубина стека: в кооперативном режиме -
+// по указателю стека при вызове планировщика и в системном тике (с кадром обработчика), отдельно отмечается
+// глубина стека в обработчике тика; в вытесняющем режиме стеки задач окрашиваются при создании задач.
+// Отчёт об использовании памяти - функции mRTOS_GetMemReport и mRTOS_PrintMemReport (отметка глубины стека
+// в кооперативном режиме - 2 байта ОЗУ на задачу). При использовании malloc куча занимает окрашенную область.
+#ifndef mRTOS_USE_STACK_MONITOR
+#define mRTOS_USE_STACK_MONITOR 0
+#endif
+#ifndef mRTOS_STACK_PAINT
+#define mRTOS_STACK_PAINT       0xC5 // значение окрашивания свободной области стека
+#endif
+
+// Группы флагов событий (struct EventGroup): флаги группы устанавливаются и сбрасываются одной операцией
+// в задачах и прерываниях; любое количество задач ожидает любой или все флаги маски с тайм-аутом и
+// необязательным сбросом флагов маски при выходе из ожидания. Установка флагов пробуждает все задачи,
+// условие ожидания которых выполнено, за один проход по списку ожидания группы
+// (2 байта ОЗУ на задачу, 3 байта при 16-разрядных флагах).
+#ifndef mRTOS_USE_EVENT_GROUPS
+#define mRTOS_USE_EVENT_GROUPS 0
+#endif
+#ifndef mRTOS_EVENT_FLAGS_BITS
+#define mRTOS_EVENT_FLAGS_BITS 8  // разрядность флагов группы событий (8 или 16)
+#endif
+
+#if mRTOS_USE_EVENT_GROUPS && (mRTOS_EVENT_FLAGS_BITS != 8) && (mRTOS_EVENT_FLAGS_BITS != 16)
+#error "mRTOS: mRTOS_EVENT_FLAGS_BITS must be 8 or 16"
+#endif
+
+// Быстрые события (mRTOS_FAST_EVENTS, 4 или 8): флаги событий и разрешения событий хранятся в битах
+// регистров младшей области ввода-вывода (адреса 0x00...0x1F, проверяется при компиляции), поэтому
+// установка, сброс и проверка события выполняются одной командой sbi/cbi/sbis без запрета прерываний
+// (номер события - константа). Быстрые события не закреплены за задачами и не пробуждают задачи: задача
+// ожидает событие опросом с вызовом диспетчера (mRTOS_FAST_EVENT_WAIT).
+// Регистры задаются явно: mRTOS_FAST_EVENT_REG - регистр флагов (по умолчанию GPIOR0, если он есть),
+// mRTOS_FAST_EVENT_ENABLE_REG - регистр разрешения. Если регистр разрешения не задан, разрешения хранятся
+// в битах 4...7 регистра флагов (4 события), иначе - в отдельном регистре (8 событий). На микроконтроллерах
+// без GPIOR0 (atmega8) регистры выбирает приложение, например -DmRTOS_FAST_EVENT_REG=TWBR
+// -DmRTOS_FAST_EVENT_ENABLE_REG=TWAR, если модуль TWI не используется.
+// Функции mRTOS_xxxEvent остаются переносимым вариантом событий с пробуждением задач.
+#ifndef mRTOS_USE_FAST_EVENTS
+#define mRTOS_USE_FAST_EVENTS 0
+#endif
+#if mRTOS_USE_FAST_EVENTS
+#if !defined(mRTOS_FAST_EVENT_REG) && defined(GPIOR0)
+#define mRTOS_FAST_EVENT_REG        GPIOR0  // регистр флагов быстрых событий
+#endif
+#ifndef mRTOS_FAST_EVENT_REG
+#error "mRTOS: no GPIOR0, define mRTOS_FAST_EVENT_REG (and mRTOS_FAST_EVENT_ENABLE_REG) as free I/O registers at 0x00...0x1F"
+#endif
+#ifndef mRTOS_FAST_EVENT_ENABLE_REG
+#define mRTOS_FAST_EVENT_ENABLE_REG   mRTOS_FAST_EVENT_REG // регистр разрешения быстрых событий - регистр флагов
+#define mRTOS_FAST_EVENT_ENABLE_SHIFT 4     // бит разрешения события n - бит n + 4
+#define mRTOS_FAST_EVENTS             4     // количество быстрых событий
+#else
+#define mRTOS_FAST_EVENT_ENABLE_SHIFT 0     // бит разрешения события n - бит n регистра разрешения
+#define mRTOS_FAST_EVENTS             8     // количество быстрых событий
+#endif
+#endif
+
+// Порт для Linux (mRTOS_PORT_HOST = 1 при сборке, см. mrtos_port_host.h) поддерживает только
+// кооперативный режим с динамическим созданием задач (системный тик - виртуальные часы порта,
+// настройка mRTOS_SYSTEM_TIMER не используется).
+#if mRTOS_PORT_HOST && (mRTOS_USE_PREEMPTIVE || mRTOS_USE_STACK_SAVE || mRTOS_USE_TICKLESS_IDLE || \
+    mRTOS_USE_STACK_MONITOR || mRTOS_USE_FAST_EVENTS || mRTOS_USE_STATIC_TASKS)
+#error "mRTOS: the host port supports the cooperative kernel with dynamic tasks only"
+#endif
+
+#if mRTOS_EVENT_FLAGS_BITS == 16
+typedef uint16_t mRTOS_EventFlags;      // флаги группы событий
+#else
+typedef uint8_t mRTOS_EventFlags;       // флаги группы событий
+#endif
+// --- структура группы флагов событий ---
+struct EventGroup {
+    mRTOS_EventFlags Flags;      // флаги событий группы
+    uint8_t WaitList;            // номер первой задачи списка ожидания (список упорядочен по приоритету)
+};
+// режимы ожидания флагов группы событий (mRTOS_FLAGS_CLEAR объединяется с mRTOS_FLAGS_ANY или mRTOS_FLAGS_ALL)
+#define mRTOS_FLAGS_ANY    0x00  // ожидание любого флага маски
+#define mRTOS_FLAGS_ALL    0x01  // ожидание всех флагов маски
+#define mRTOS_FLAGS_CLEAR  0x02  // сброс флагов маски при выходе из ожидания
+
+// доступ к полям блока контроля задачи под номером n
+#if mRTOS_USE_PACKED_TCB
+#define mRTOS_STATE_DELAYED     0x80                  // признак не истёкшей задержки задачи в состоянии Wait
+#define mRTOS_TASK_STATE(n)     mRTOS_TaskState[n]
+#define mRTOS_TASK_CREDIT(n)    mRTOS_TaskCredit[n]
+#define mRTOS_TASK_PRIORITY(n)  mRTOS_TaskPriority[n]
+#define mRTOS_TASK_CONTEXT(n)   mRTOS_TaskContext[n]
+#else
+#define mRTOS_TASK_STATE(n)     mRTOS_Tasks[n].State
+#define mRTOS_TASK_CREDIT(n)    mRTOS_Tasks[n].CurrentPriority
+#define mRTOS_TASK_PRIORITY(n)  mRTOS_Tasks[n].Priority
+#define mRTOS_TASK_CONTEXT(n)   mRTOS_Tasks[n].Context
+#endif
 
 // вызов функции диспетчера задач
-#define mRTOS_DISPATCH  mRTOS_DispatchTask(&mRTOS_Tasks[mRTOS_CurrentTask].Context)
+#define mRTOS_DISPATCH  mRTOS_DispatchTask(&mRTOS_TASK_CONTEXT(mRTOS_CurrentTask))
 // вызов функции перевода текущей задачи в состояние Wait на время d тиков (d = 0 .. 65535)
-#define mRTOS_TASK_WAIT(d)  mRTOS_WaitTask(d, &mRTOS_Tasks[mRTOS_CurrentTask].Context)
+#define mRTOS_TASK_WAIT(d)  mRTOS_WaitTask(d, &mRTOS_TASK_CONTEXT(mRTOS_CurrentTask))
+// вызов функции перевода текущей задачи в состояние Wait до момента t системного времени в тиках
+// (не далее 65535 тиков; если момент t уже наступил, задача только вызывает планировщик)
+#define mRTOS_TASK_WAIT_UNTIL(t)  mRTOS_WaitUntil(t, &mRTOS_TASK_CONTEXT(mRTOS_CurrentTask))
+#if mRTOS_USE_PERIODIC_TASKS
+// вызов функции ожидания следующего выпуска текущей периодической задачи
+#define mRTOS_TASK_WAIT_PERIOD  mRTOS_WaitPeriod(&mRTOS_TASK_CONTEXT(mRTOS_CurrentTask))
+#endif
+// момент a системного времени предшествует моменту b (с учётом переполнения счётчика времени)
+#define mRTOS_TIME_BEFORE(a, b)  ((int32_t)((uint32_t)(a) - (uint32_t)(b)) < 0)
+// вызов функции ожидания события под номером n с тайм-аутом t тиков (t = 0 - без тайм-аута);
+// после возврата результат проверяется функцией mRTOS_GetEvent(n) (0 - истёк тайм-аут)
+#define mRTOS_EVENT_WAIT(n, t)  mRTOS_WaitEvent(n, t, &mRTOS_TASK_CONTEXT(mRTOS_CurrentTask))
+#if mRTOS_USE_EVENT_GROUPS
+// вызов функции ожидания флагов mask группы событий g в режиме o (mRTOS_FLAGS_xxx) с тайм-аутом t тиков
+// (t = 0 - без тайм-аута); после возврата результат читается функцией mRTOS_GetWaitFlags() (0 - истёк тайм-аут)
+#define mRTOS_EVENT_FLAGS_WAIT(g, mask, o, t)  mRTOS_WaitEventFlags(&(g), mask, o, t, &mRTOS_TASK_CONTEXT(mRTOS_CurrentTask))
+#endif
+#if mRTOS_USE_FAST_EVENTS
+// ожидание быстрого события под номером n опросом с вызовом диспетчера (событие не сбрасывается)
+#define mRTOS_FAST_EVENT_WAIT(n)  while(!mRTOS_FastPopEvent(n)) mRTOS_DISPATCH
+#endif
+// вызов функции ожидания (захвата) счётного семафора s
+#define mRTOS_SEMAPHORE_WAIT(s)  mRTOS_WaitSemaphore(&(s), &mRTOS_TASK_CONTEXT(mRTOS_CurrentTask))
+// вызов функции захвата мьютекса m (мьютекс не рекурсивный)
+#define mRTOS_MUTEX_LOCK(m)  mRTOS_LockMutex(&(m), &mRTOS_TASK_CONTEXT(mRTOS_CurrentTask))
 // вызов функции перевода задачи под номером n в состояние Active
 #define mRTOS_TASK_ACTIVE(n)  mRTOS_SetTaskNStatus(n, ACTIVE)
 // вызов функции перевода текущей задачи в состояние Stop с последующим вызовом диспетчера задач
@@ -71,8 +543,9 @@ struct ECB {
 // --- Функции mRTOS ---
 
 void mRTOS_Init(void);                           // функция инициализация OS
-uint8_t mRTOS_CreateTask(void (*Task)(void), uint8_t Priority, enum TaskState State); // функция создания задачи
+uint8_t mRTOS_CreateTask(void (*Task)(void), uint8_t Priority, enum TaskState State); // функция создания задачи (при статической таблице задач вызывается только из mRTOS_Init)
 void mRTOS_WaitTask(uint16_t Delay, struct TaskContext* TaskContextPtr); // функция перевода задачи в состояняие Wait на время Delay тиков
+void mRTOS_WaitUntil(uint32_t WakeTime, struct TaskContext* TaskContextPtr); // функция перевода задачи в состояние Wait до момента WakeTime системного времени
 void mRTOS_DispatchTask(struct TaskContext* TaskContextPtr); // функция вызова диспетчера задач
 void mRTOS_Scheduler(void);                      // функция планировщика задач
 void mRTOS_SetTaskStatus(enum TaskState Status); // функция перевода текущей задачи в состояние Status
@@ -87,13 +560,138 @@ uint8_t mRTOS_SetEvent(uint8_t EventNumber);     // функция устано
 uint8_t mRTOS_SetEventValue(uint8_t EventNumber, uint8_t FlagEventValue); // функция установки значения флага события FlagEventValue под номером EventNumber
 uint8_t mRTOS_GetEvent(uint8_t EventNumber);     // функция чтения состояния события под номером EventNumber с последующим сбросом события
 uint8_t mRTOS_PopEvent(uint8_t EventNumber);     // функция чтения состояния события под номером EventNumber без сброса события
+void mRTOS_WaitEvent(uint8_t EventNumber, uint16_t Timeout, struct TaskContext* TaskContextPtr); // функция ожидания события под номером EventNumber с тайм-аутом Timeout тиков
+
+#if mRTOS_USE_FAST_EVENTS
+// -- функции работы с быстрыми событиями (EventNumber = 0...mRTOS_FAST_EVENTS - 1, константа) --
+
+/**
+* Функция разрешения быстрого события
+* входной параметр:
+* \param EventNumber - номер события
+*/
+static inline void mRTOS_FastEnableEvent(uint8_t EventNumber) __attribute__((always_inline));
+static inline void mRTOS_FastEnableEvent(uint8_t EventNumber) {
+    mRTOS_FAST_EVENT_ENABLE_REG |= _BV(EventNumber + mRTOS_FAST_EVENT_ENABLE_SHIFT);  // sbi
+}
+
+/**
+* Функция запрета быстрого события (флаг события не сбрасывается)
+* входной параметр:
+* \param EventNumber - номер события
+*/
+static inline void mRTOS_FastDisableEvent(uint8_t EventNumber) __attribute__((always_inline));
+static inline void mRTOS_FastDisableEvent(uint8_t EventNumber) {
+    mRTOS_FAST_EVENT_ENABLE_REG &= ~_BV(EventNumber + mRTOS_FAST_EVENT_ENABLE_SHIFT); // cbi
+}
+
+/**
+* Функция установки быстрого события, если оно разрешено (допускается вызов
+* из прерывания)
+* входной параметр:
+* \param EventNumber - номер события
+*/
+static inline void mRTOS_FastSetEvent(uint8_t EventNumber) __attribute__((always_inline));
+static inline void mRTOS_FastSetEvent(uint8_t EventNumber) {
+    if(mRTOS_FAST_EVENT_ENABLE_REG & _BV(EventNumber + mRTOS_FAST_EVENT_ENABLE_SHIFT)) // sbis
+        mRTOS_FAST_EVENT_REG |= _BV(EventNumber);      // sbi
+}
+
+/**
+* Функция чтения состояния быстрого события с последующим сбросом события;
+* установка события между проверкой и сбросом объединяется с прочитанной
+* входной параметр:
+* \param EventNumber - номер события
+* возвращает:
+* \return 1 - событие было установлено
+* \return 0 - событие не установлено
+*/
+static inline uint8_t mRTOS_FastGetEvent(uint8_t EventNumber) __attribute__((always_inline));
+static inline uint8_t mRTOS_FastGetEvent(uint8_t EventNumber) {
+    if(!(mRTOS_FAST_EVENT_REG & _BV(EventNumber)))     // sbic
+        return 0;
+    mRTOS_FAST_EVENT_REG &= ~_BV(EventNumber);         // cbi
+    return 1;
+}
+
+/**
+* Функция чтения состояния быстрого события без сброса события
+* входной параметр:
+* \param EventNumber - номер события
+* возвращает:
+* \return 1 - событие установлено
+* \return 0 - событие не установлено
+*/
+static inline uint8_t mRTOS_FastPopEvent(uint8_t EventNumber) __attribute__((always_inline));
+static inline uint8_t mRTOS_FastPopEvent(uint8_t EventNumber) {
+    return (mRTOS_FAST_EVENT_REG & _BV(EventNumber)) ? 1 : 0; // sbis
+}
+#endif
+
+#if mRTOS_USE_EVENT_GROUPS
+
+// -- функции работы с группами флагов событий --
+
+void mRTOS_InitEventGroup(struct EventGroup* GroupPtr);            // функция инициализации группы событий (флаги сброшены)
+mRTOS_EventFlags mRTOS_SetEventFlags(struct EventGroup* GroupPtr, mRTOS_EventFlags Flags);   // функция установки флагов Flags группы событий (допускается вызов из прерывания)
+mRTOS_EventFlags mRTOS_ClearEventFlags(struct EventGroup* GroupPtr, mRTOS_EventFlags Flags); // функция сброса флагов Flags группы событий (допускается вызов из прерывания)
+mRTOS_EventFlags mRTOS_GetEventFlags(struct EventGroup* GroupPtr); // функция чтения флагов группы событий
+void mRTOS_WaitEventFlags(struct EventGroup* GroupPtr, mRTOS_EventFlags Mask, uint8_t Mode, uint16_t Timeout, struct TaskContext* TaskContextPtr); // функция ожидания флагов Mask группы событий с тайм-аутом Timeout тиков
+mRTOS_EventFlags mRTOS_GetWaitFlags(void);                         // функция чтения результата ожидания флагов текущей задачей
+#endif
+
+// -- функции работы с семафорами и мьютексами --
+
+void mRTOS_InitSemaphore(struct Semaphore* SemaphorePtr, uint8_t Count); // функция инициализации счётного семафора начальным значением Count
+void mRTOS_WaitSemaphore(struct Semaphore* SemaphorePtr, struct TaskContext* TaskContextPtr); // функция ожидания (захвата) семафора
+uint8_t mRTOS_TryWaitSemaphore(struct Semaphore* SemaphorePtr);   // функция захвата семафора без ожидания
+uint8_t mRTOS_SignalSemaphore(struct Semaphore* SemaphorePtr);    // функция освобождения семафора (допускается вызов из прерывания)
+void mRTOS_InitMutex(struct Mutex* MutexPtr);                     // функция инициализации мьютекса
+void mRTOS_LockMutex(struct Mutex* MutexPtr, struct TaskContext* TaskContextPtr); // функция захвата мьютекса с ожиданием
+uint8_t mRTOS_TryLockMutex(struct Mutex* MutexPtr);               // функция захвата мьютекса без ожидания
+uint8_t mRTOS_UnlockMutex(struct Mutex* MutexPtr);                // функция освобождения мьютекса задачей-владельцем
+
+#if mRTOS_USE_PERIODIC_TASKS
+uint8_t mRTOS_SetTaskPeriod(uint8_t TaskNumber, uint16_t Period); // функция задания периода выпуска задачи под номером TaskNumber
+void mRTOS_WaitPeriod(struct TaskContext* TaskContextPtr);        // функция ожидания следующего выпуска текущей задачи
+uint8_t mRTOS_GetTaskMissed(uint8_t TaskNumber);                  // функция чтения количества пропущенных выпусков задачи под номером TaskNumber
+#endif
+
+#if mRTOS_USE_JOBS
+uint8_t mRTOS_CreateJob(void (*Job)(void), uint8_t Priority); // функция создания задачи выполнения до завершения (номера - по порядку создания)
+uint8_t mRTOS_PostJob(uint8_t JobNumber);                     // функция запроса выполнения задачи-job под номером JobNumber (допускается вызов из прерывания)
+uint8_t mRTOS_SetJobPeriod(uint8_t JobNumber, uint16_t Period); // функция задания периода выполнения задачи-job под номером JobNumber
+#endif
+
+#if mRTOS_USE_TASK_BUDGET
+uint8_t mRTOS_SetTaskBudget(uint8_t TaskNumber, uint16_t Budget); // функция задания бюджета времени выполнения задачи под номером TaskNumber
+uint16_t mRTOS_GetTaskRunMax(uint8_t TaskNumber);                 // функция чтения наибольшей длительности выполнения задачи под номером TaskNumber
+uint8_t mRTOS_GetTaskOverruns(uint8_t TaskNumber);                // функция чтения количества превышений бюджета задачей под номером TaskNumber
+#endif
+
+#if mRTOS_USE_STACK_SAVE
+uint8_t mRTOS_GetStackSaveMax(uint8_t TaskNumber); // функция чтения наибольшего размера сегмента стека задачи под номером TaskNumber
+#endif
 
 // -- функции работы с системным временем --
 
 void mRTOS_SetSystemTime(uint32_t Time);         // функция установки системного времени в тиках
-uint32_t mRTOS_GetSystemTime(void);              // функция чтения текущего значения системного времени в тиках
+uint32_t mRTOS_GetSystemTime(void);              // функция чтения текущего значения системного времени в тиках (без запрета прерываний)
+#if mRTOS_USE_TIME64
+uint64_t mRTOS_GetSystemTime64(void);            // функция чтения 64-разрядного системного времени в тиках
+#endif
+#if mRTOS_USE_HIRES_TIME
+mRTOS_Micros mRTOS_GetTimeMicros(void);          // функция чтения системного времени в микросекундах (без запрета прерываний)
+#endif
 
+#if mRTOS_USE_PACKED_TCB
+extern uint8_t mRTOS_TaskState[mRTOS_MAX_TASKS];           // состояния задач
+extern uint8_t mRTOS_TaskCredit[mRTOS_MAX_TASKS];          // текущие приоритеты (кредиты) задач
+extern uint8_t mRTOS_TaskPriority[mRTOS_MAX_TASKS];        // приоритеты задач
+extern struct TaskContext mRTOS_TaskContext[mRTOS_MAX_TASKS]; // контексты задач
+#else
 extern volatile struct TCB mRTOS_Tasks[mRTOS_MAX_TASKS]; // массив структур TCB всех задач приложения (Task Control Block)
+#endif
 extern uint8_t mRTOS_CurrentTask;                // номер текущей задачи
 
 #endif
@@ -0,0 +1,29 @@
+/******************************************************************************
+* File Name     : 'mrtos_config.h'
+* Title         : Application task and event tables of mRTOS
+* Target MCU    : Atmel AVR
+* Editor Tabs   : 4
+*
+* Notes:          Статическая таблица задач и событий приложения
+*                 (mRTOS_USE_STATIC_TASKS = 1): файл принадлежит приложению
+*                 и включается из mrtos.h; ядро содержит только макросы
+*                 разворачивания таблиц. Таблицы этого файла соответствуют
+*                 main.c.
+*
+* This code is distributed under the GNU Public License
+* which can be found at http://www.gnu.org/licenses/gpl.txt
+*******************************************************************************/
+
+#ifndef mRTOS_CONFIG_H_INCLUDED
+#define mRTOS_CONFIG_H_INCLUDED
+
+// таблица задач приложения: TASK(функция задачи, приоритет 1...255, начальное состояние);
+// номер задачи - mRTOS_TASK_ID(функция задачи) (задача Idle имеет номер 0)
+#define mRTOS_TASK_TABLE(TASK) \
+        TASK(task1, 10, ACTIVE)
+// таблица событий приложения: EVENT(имя события, функция задачи, за которой закреплено событие);
+// номер события - mRTOS_EVENT_ID(имя события)
+#define mRTOS_EVENT_TABLE(EVENT) \
+        EVENT(event1, task1)
+
+#endif
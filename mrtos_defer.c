@@ -0,0 +1,143 @@
+/******************************************************************************
+* File Name     : 'mrtos_defer.c'
+* Title         : Deferred interrupt work queue of mRTOS
+* Target MCU    : Atmel AVR series
+* Editor Tabs   : 4
+*
+* Notes:          Кольцевой буфер элементов: индексы начала и конца
+*                 изменяются при запрещённых прерываниях, функция элемента
+*                 выполняется задачей обслуживания при разрешённых
+*                 прерываниях. Задача обслуживания ожидает семафор
+*                 mRTOS_DeferSemaphore, который освобождается при помещении
+*                 элемента в пустую очередь, если он ещё не освобождён
+*                 (задача обслуживания, опустошившая очередь до ожидания
+*                 семафора, не накапливает лишних проходов).
+*
+* This code is distributed under the GNU Public License
+* which can be found at http://www.gnu.org/licenses/gpl.txt
+*******************************************************************************/
+
+#include "mrtos_port.h"
+#include <inttypes.h>
+#include "mrtos.h"
+#include "mrtos_defer.h"
+
+#if mRTOS_USE_DEFER
+
+#define mRTOS_DEFER_MASK (mRTOS_DEFER_QUEUE_SIZE - 1)
+
+static struct DeferItem mRTOS_DeferQueue[mRTOS_DEFER_QUEUE_SIZE]; // буфер очереди
+static uint8_t mRTOS_DeferHead,              // индекс первого элемента очереди
+mRTOS_DeferCount,                            // количество элементов в очереди
+mRTOS_DeferHighWater;                        // наибольшее количество элементов в очереди
+static uint16_t mRTOS_DeferOverflows;        // количество элементов, не помещённых в заполненную очередь
+static struct Semaphore mRTOS_DeferSemaphore = { 0, 0xFF }; // семафор пробуждения задачи обслуживания очереди
+
+/**
+* Функция помещения функции отложенной обработки в очередь (допускается
+* вызов из прерывания)
+* входные параметры:
+* \param Function - функция отложенной обработки;
+* \param Arg - аргумент функции.
+* возвращает:
+* \return 1 - функция помещена в очередь
+* \return 0 - ошибка, очередь заполнена (переполнение учитывается)
+*/
+uint8_t mRTOS_DeferPost(void (*Function)(uint16_t Arg), uint16_t Arg) {
+    struct DeferItem* ItemPtr;
+    uint8_t temp = 0;
+    mRTOS_PORT_CRITICAL() {
+        if(mRTOS_DeferCount == mRTOS_DEFER_QUEUE_SIZE) { // если очередь заполнена, то
+            if(mRTOS_DeferOverflows != 0xFFFF)
+                mRTOS_DeferOverflows++;      // учесть переполнение
+        } else {
+            ItemPtr = &mRTOS_DeferQueue[(mRTOS_DeferHead + mRTOS_DeferCount) & mRTOS_DEFER_MASK];
+            ItemPtr->Function = Function;
+            ItemPtr->Arg = Arg;
+            if(!mRTOS_DeferCount++ && !mRTOS_DeferSemaphore.Count) // если очередь была пуста и семафор не освобождён, то
+                mRTOS_SignalSemaphore(&mRTOS_DeferSemaphore); // пробудить задачу обслуживания
+            if(mRTOS_DeferCount > mRTOS_DeferHighWater)
+                mRTOS_DeferHighWater = mRTOS_DeferCount; // наибольшая глубина очереди
+            temp = 1;
+        }
+    }
+    return temp;
+}
+
+/**
+* Функция извлечения первого элемента очереди
+* входной параметр:
+* \param ItemPtr - указатель на структуру для извлечённого элемента
+* возвращает:
+* \return 1 - элемент извлечён
+* \return 0 - очередь пуста
+*/
+static uint8_t mRTOS_DeferTake(struct DeferItem* ItemPtr) __attribute__((noinline));
+static uint8_t mRTOS_DeferTake(struct DeferItem* ItemPtr) {
+    uint8_t temp = 0;
+    mRTOS_PORT_CRITICAL() {
+        if(mRTOS_DeferCount) {               // если очередь не пуста, то
+            *ItemPtr = mRTOS_DeferQueue[mRTOS_DeferHead]; // извлечь первый элемент
+            mRTOS_DeferHead = (mRTOS_DeferHead + 1) & mRTOS_DEFER_MASK;
+            mRTOS_DeferCount--;
+            temp = 1;
+        }
+    }
+    return temp;
+}
+
+/**
+* Функция задачи обслуживания очереди отложенной обработки: функции
+* выполняются в порядке помещения, после каждых mRTOS_DEFER_BATCH функций
+* вызывается диспетчер задач
+*/
+void mRTOS_DeferService(void) {
+    static struct DeferItem item;            // элемент очереди (static - сохраняется при вызове диспетчера)
+    static uint8_t batch;                    // количество функций, выполненных в текущей пачке
+    while(1) {
+        batch = 0;
+        while(mRTOS_DeferTake(&item)) {      // цикл по элементам очереди
+            item.Function(item.Arg);         // выполнить функцию отложенной обработки
+            if(++batch == mRTOS_DEFER_BATCH) { // если пачка выполнена, то
+                batch = 0;
+                mRTOS_DISPATCH;              // отдать управление другим задачам
+            }
+        }
+        mRTOS_SEMAPHORE_WAIT(mRTOS_DeferSemaphore); // ожидать помещения элемента в пустую очередь
+    }
+}
+
+/**
+* Функция чтения наибольшей глубины очереди отложенной обработки
+* возвращает:
+* \return наибольшее количество элементов в очереди
+*/
+uint8_t mRTOS_GetDeferHighWater(void) {
+    return mRTOS_DeferHighWater;
+}
+
+/**
+* Функция чтения количества переполнений очереди отложенной обработки
+* возвращает:
+* \return количество элементов, не помещённых в заполненную очередь (до 65535)
+*/
+uint16_t mRTOS_GetDeferOverflows(void) {
+    uint16_t temp;
+    mRTOS_PORT_CRITICAL() {
+        temp = mRTOS_DeferOverflows;
+    }
+    return temp;
+}
+
+/**
+* Функция сброса статистики очереди отложенной обработки (наибольшая
+* глубина становится равной текущей)
+*/
+void mRTOS_ClearDeferStats(void) {
+    mRTOS_PORT_CRITICAL() {
+        mRTOS_DeferHighWater = mRTOS_DeferCount;
+        mRTOS_DeferOverflows = 0;
+    }
+}
+
+#endif
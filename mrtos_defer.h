@@ -0,0 +1,49 @@
+/******************************************************************************
+* File Name     : 'mrtos_defer.h'
+* Title         : Deferred interrupt work queue of mRTOS
+* Target MCU    : Atmel AVR
+* Editor Tabs   : 4
+*
+* Notes:          Очередь отложенной обработки (mRTOS_USE_DEFER): обработчик
+*                 прерывания выполняет только неотложную часть работы и
+*                 помещает в очередь функцию с аргументом; функции
+*                 выполняются в порядке помещения задачей mRTOS_DeferService,
+*                 которую приложение создаёт как обычную задачу с наибольшим
+*                 приоритетом (или включает в статическую таблицу задач).
+*                 После mRTOS_DEFER_BATCH функций задача вызывает диспетчер,
+*                 поэтому длинная очередь не задерживает другие задачи
+*                 дольше одной пачки. Для подбора размера очереди
+*                 подсчитываются наибольшая глубина очереди и количество
+*                 переполнений. Функция очереди не должна ожидать
+*                 (mRTOS_TASK_WAIT, семафоры и т. п.).
+*
+* This code is distributed under the GNU Public License
+* which can be found at http://www.gnu.org/licenses/gpl.txt
+*******************************************************************************/
+
+#ifndef mRTOS_DEFER_H_INCLUDED
+#define mRTOS_DEFER_H_INCLUDED
+
+#if mRTOS_USE_DEFER
+
+#if (mRTOS_DEFER_QUEUE_SIZE & (mRTOS_DEFER_QUEUE_SIZE - 1)) || (mRTOS_DEFER_QUEUE_SIZE > 128)
+#error "mRTOS: mRTOS_DEFER_QUEUE_SIZE must be a power of two up to 128"
+#endif
+
+// --- элемент очереди отложенной обработки ---
+struct DeferItem {
+    void (*Function)(uint16_t Arg);  // функция отложенной обработки
+    uint16_t Arg;                    // аргумент функции
+};
+
+// --- Функции очереди отложенной обработки ---
+
+uint8_t mRTOS_DeferPost(void (*Function)(uint16_t Arg), uint16_t Arg); // функция помещения функции в очередь (из прерывания или задачи)
+void mRTOS_DeferService(void);                   // функция задачи обслуживания очереди
+uint8_t mRTOS_GetDeferHighWater(void);           // функция чтения наибольшей глубины очереди
+uint16_t mRTOS_GetDeferOverflows(void);          // функция чтения количества переполнений очереди
+void mRTOS_ClearDeferStats(void);                // функция сброса статистики очереди
+
+#endif
+
+#endif
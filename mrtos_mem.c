@@ -0,0 +1,102 @@
+/******************************************************************************
+* File Name     : 'mrtos_mem.c'
+* Title         : Fixed-block memory pools of mRTOS
+* Target MCU    : Atmel AVR series
+* Editor Tabs   : 4
+*
+* Notes:          Количество свободных блоков пула хранится в счётчике
+*                 семафора Free, поэтому задача, ожидающая блок, получает
+*                 его сразу при освобождении блока другой задачей или
+*                 прерыванием.
+*
+* This code is distributed under the GNU Public License
+* which can be found at http://www.gnu.org/licenses/gpl.txt
+*******************************************************************************/
+
+#include "mrtos_port.h"
+#include <inttypes.h>
+#include "mrtos.h"
+#include "mrtos_mem.h"
+
+/**
+* Функция извлечения свободного блока из пула (вызывается при запрещённых
+* прерываниях, свободный блок должен быть зарезервирован)
+* входной параметр:
+* \param PoolPtr - указатель на структуру пула
+* возвращает:
+* \return адрес блока
+*/
+static inline void* mRTOS_MemPop(struct MemPool* PoolPtr) {
+    uint8_t* block = PoolPtr->FreeList;
+    if(block)                                            // если есть освобождённые блоки, то
+        PoolPtr->FreeList = *(uint8_t**)block;           // исключить первый из списка
+    else                                                 // иначе взять следующий блок из памяти пула
+        block = PoolPtr->Memory + (uint16_t)PoolPtr->BlockSize * PoolPtr->Allocated++;
+    if(++PoolPtr->Used > PoolPtr->MaxUsed)               // обновить статистику пула
+        PoolPtr->MaxUsed = PoolPtr->Used;
+    return block;
+}
+
+/**
+* Функция выделения блока из пула без ожидания
+* входной параметр:
+* \param PoolPtr - указатель на структуру пула
+* возвращает:
+* \return адрес блока
+* \return 0 - свободных блоков нет
+*/
+void* mRTOS_MemAlloc(struct MemPool* PoolPtr) {
+    void* block = 0;
+    mRTOS_PORT_CRITICAL() {
+        if(PoolPtr->Free.Count) {                        // если есть свободные блоки, то
+            PoolPtr->Free.Count--;                       // зарезервировать блок
+            block = mRTOS_MemPop(PoolPtr);               // и выделить его
+        } else
+            PoolPtr->Fails++;                            // иначе учесть неудачную попытку
+    }
+    return block;
+}
+
+/**
+* Функция выделения блока, зарезервированного захватом семафора Free пула
+* (используется макросом mRTOS_MEM_ALLOC_WAIT)
+* входной параметр:
+* \param PoolPtr - указатель на структуру пула
+* возвращает:
+* \return адрес блока
+*/
+void* mRTOS_MemTake(struct MemPool* PoolPtr) {
+    void* block;
+    mRTOS_PORT_CRITICAL() {
+        block = mRTOS_MemPop(PoolPtr);
+    }
+    return block;
+}
+
+/**
+* Функция освобождения блока: блок передаётся задаче, ожидающей блок
+* этого пула, или возвращается в пул
+* входные параметры:
+* \param PoolPtr - указатель на структуру пула
+* \param BlockPtr - адрес освобождаемого блока
+*/
+void mRTOS_MemFree(struct MemPool* PoolPtr, void* BlockPtr) {
+    mRTOS_PORT_CRITICAL() {
+        *(uint8_t**)BlockPtr = PoolPtr->FreeList;        // включить блок в список освобождённых блоков
+        PoolPtr->FreeList = BlockPtr;
+        PoolPtr->Used--;
+        mRTOS_SignalSemaphore(&PoolPtr->Free);           // отметить блок свободным (или передать ожидающей задаче)
+    }
+}
+
+/**
+* Функция сброса статистики пула
+* входной параметр:
+* \param PoolPtr - указатель на структуру пула
+*/
+void mRTOS_MemResetStat(struct MemPool* PoolPtr) {
+    mRTOS_PORT_CRITICAL() {
+        PoolPtr->MaxUsed = PoolPtr->Used;
+        PoolPtr->Fails = 0;
+    }
+}
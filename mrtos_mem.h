@@ -0,0 +1,61 @@
+/******************************************************************************
+* File Name     : 'mrtos_mem.h'
+* Title         : Fixed-block memory pools of mRTOS
+* Target MCU    : Atmel AVR
+* Editor Tabs   : 4
+*
+* Notes:          Пулы блоков фиксированного размера, объявляемые на этапе
+*                 компиляции. Выделение и освобождение блока выполняются за
+*                 постоянное время и допускаются в прерываниях; задача может
+*                 ожидать освобождения блока (mRTOS_MEM_ALLOC_WAIT).
+*                 Не более 255 блоков в пуле, размер блока не менее размера
+*                 указателя (2 байта на AVR). Размер блока округляется до
+*                 кратного выравниванию указателя, поэтому каждый блок
+*                 выровнен для хранения адреса следующего свободного блока
+*                 (на AVR выравнивание - 1 байт, размер не изменяется).
+*
+* This code is distributed under the GNU Public License
+* which can be found at http://www.gnu.org/licenses/gpl.txt
+*******************************************************************************/
+
+#ifndef mRTOS_MEM_H_INCLUDED
+#define mRTOS_MEM_H_INCLUDED
+
+// --- структура пула блоков памяти ---
+struct MemPool {
+    struct Semaphore Free;       // семафор свободных блоков (значение счётчика - количество свободных блоков)
+    uint8_t* FreeList;           // первый блок списка освобождённых блоков (адрес следующего хранится в начале блока)
+    uint8_t* Memory;             // память блоков пула
+    uint8_t BlockSize,           // размер блока в байтах
+    BlockCount,                  // количество блоков в пуле
+    Allocated,                   // количество блоков, хотя бы раз выделенных из памяти пула
+    Used,                        // количество занятых блоков
+    MaxUsed,                     // максимальное количество одновременно занятых блоков (high-water)
+    Fails;                       // количество неудачных попыток выделения блока без ожидания
+};
+
+// размер блока blocksize, округлённый до кратного выравниванию указателя
+#define mRTOS_MEM_BLOCK_SIZE(blocksize) \
+    (((blocksize) + __alignof__(void*) - 1) & ~(__alignof__(void*) - 1))
+
+// объявление пула name из count блоков по blocksize байт (инициализация во время выполнения не требуется)
+#define mRTOS_MEM_POOL(name, blocksize, count) \
+    typedef char name##_block_size_must_hold_a_pointer[((blocksize) >= sizeof(void*)) && \
+        (mRTOS_MEM_BLOCK_SIZE(blocksize) <= 255) && ((count) >= 1) && ((count) <= 255) ? 1 : -1]; \
+    static uint8_t name##_Memory[(uint16_t)mRTOS_MEM_BLOCK_SIZE(blocksize) * (count)] __attribute__((aligned(__alignof__(void*)))); \
+    struct MemPool name = { { (count), 0xFF }, 0, name##_Memory, mRTOS_MEM_BLOCK_SIZE(blocksize), (count), 0, 0, 0, 0 }
+
+// вызов выделения блока из пула p с ожиданием освобождения блока; адрес блока присваивается ptr
+#define mRTOS_MEM_ALLOC_WAIT(p, ptr) { \
+    mRTOS_SEMAPHORE_WAIT((p).Free); \
+    (ptr) = mRTOS_MemTake(&(p)); \
+}
+
+// --- Функции пулов памяти ---
+
+void* mRTOS_MemAlloc(struct MemPool* PoolPtr);             // функция выделения блока без ожидания (допускается вызов из прерывания)
+void* mRTOS_MemTake(struct MemPool* PoolPtr);              // функция выделения блока, зарезервированного захватом семафора Free
+void mRTOS_MemFree(struct MemPool* PoolPtr, void* BlockPtr); // функция освобождения блока (допускается вызов из прерывания)
+void mRTOS_MemResetStat(struct MemPool* PoolPtr);          // функция сброса статистики пула
+
+#endif
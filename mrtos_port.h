@@ -0,0 +1,50 @@
+/******************************************************************************
+* File Name     : 'mrtos_port.h'
+* Title         : Port layer of mRTOS
+* Target MCU    : Atmel AVR, Linux (host)
+* Editor Tabs   : 4
+*
+* Notes:          Аппаратно-зависимые части ядра. Порт выбирается при
+*                 сборке: по умолчанию - AVR (заголовки avr-libc,
+*                 mrtos_port_avr.h), mRTOS_PORT_HOST = 1 - Linux
+*                 (mrtos_port_host.h, mrtos_port_host.c) для проверки и
+*                 измерения планировщика на рабочей станции.
+*                 Модули ядра включают этот заголовок вместо заголовков
+*                 avr-libc, а после mrtos.h - mrtos_port_avr.h (функции
+*                 порта AVR, зависящие от настроек ядра).
+*                 Функции порта, используемые ядром:
+*                 mRTOS_PORT_CRITICAL() - критическая секция с
+*                 восстановлением состояния прерываний;
+*                 mRTOS_PortTickStart, mRTOS_PortTickReload,
+*                 mRTOS_PortTickCounts, mRTOS_PORT_TICK_ISR() - источник
+*                 системного тика;
+*                 mRTOS_PortIdle - действие (сон) в цикле задачи Idle;
+*                 mRTOS_PortTraceOut - вывод байта трассировки;
+*                 mRTOS_PortInitTask, mRTOS_PortSwitch - передача
+*                 управления задачам (порт Linux; на AVR передача
+*                 управления выполняется ассемблерными вставками
+*                 планировщика в mrtos.c, работающими с его кадром стека).
+*
+* This code is distributed under the GNU Public License
+* which can be found at http://www.gnu.org/licenses/gpl.txt
+*******************************************************************************/
+
+#ifndef mRTOS_PORT_H_INCLUDED
+#define mRTOS_PORT_H_INCLUDED
+
+#ifndef mRTOS_PORT_HOST                  // значение задаётся при сборке (-D)
+#define mRTOS_PORT_HOST 0                // 1 - порт для Linux
+#endif
+
+#if mRTOS_PORT_HOST
+#include "mrtos_port_host.h"
+#else
+#include <avr/io.h>
+#include <util/atomic.h>
+#include <avr/pgmspace.h>
+#include <avr/sleep.h>
+
+#define mRTOS_PORT_CRITICAL()  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) // критическая секция
+#endif
+
+#endif
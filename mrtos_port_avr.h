@@ -0,0 +1,126 @@
+/******************************************************************************
+* File Name     : 'mrtos_port_avr.h'
+* Title         : AVR port of mRTOS
+* Target MCU    : Atmel AVR series
+* Editor Tabs   : 4
+*
+* Notes:          Функции порта AVR, зависящие от настроек ядра (mrtos.h):
+*                 запуск и чтение таймера системного тика (T0, T1 или T2),
+*                 обработчик прерывания тика, действие задачи Idle и вывод
+*                 байта трассировки через UART. Модули ядра включают этот
+*                 заголовок после mrtos.h; для порта Linux те же функции
+*                 объявлены в mrtos_port_host.h.
+*
+* This code is distributed under the GNU Public License
+* which can be found at http://www.gnu.org/licenses/gpl.txt
+*******************************************************************************/
+
+#ifndef mRTOS_PORT_AVR_H_INCLUDED
+#define mRTOS_PORT_AVR_H_INCLUDED
+
+#if !mRTOS_PORT_HOST
+
+// таймер системного тика: счётчик (младший байт), флаг прерывания тика в TIFR, вектор прерывания тика
+// и значение счётчика в начале тика
+#if mRTOS_SYSTEM_TIMER == 1
+#define mRTOS_TIMER_COUNTER  TCNT1L
+#define mRTOS_TIMER_FLAG     OCF1A
+#define mRTOS_TIMER_vect     TIMER1_COMPA_vect
+#define mRTOS_TIMER_START    0
+#elif mRTOS_SYSTEM_TIMER == 2
+#define mRTOS_TIMER_COUNTER  TCNT2
+#define mRTOS_TIMER_FLAG     OCF2
+#define mRTOS_TIMER_vect     TIMER2_COMP_vect
+#define mRTOS_TIMER_START    0
+#else
+#define mRTOS_TIMER_COUNTER  TCNT0
+#define mRTOS_TIMER_FLAG     TOV0
+#define mRTOS_TIMER_vect     TIMER0_OVF_vect
+#define mRTOS_TIMER_START    mRTOS_SYSTEM_TIMER_RELOAD_VALUE
+#endif
+
+// заголовок обработчика прерывания таймера системного тика
+#define mRTOS_PORT_TICK_ISR()  ISR(mRTOS_TIMER_vect)
+
+/**
+* Функция запуска таймера системного тика
+*/
+static inline void mRTOS_PortTickStart(void) {
+#if mRTOS_SYSTEM_TIMER == 1
+    TCCR1A = 0;                                  // инициализация системного таймера (T1, режим CTC)
+    TCNT1 = 0;
+    OCR1A = mRTOS_TICK_COUNTS - 1;
+    TIFR = _BV(OCF1A);
+    TIMSK |= _BV(OCIE1A);                        // разрешить прерывание системного тика
+    TCCR1B = _BV(WGM12) | mRTOS_SYSTEM_TIMER_PRESCALER_VALUE; // запуск системного таймера
+#elif mRTOS_SYSTEM_TIMER == 2
+    TCNT2 = 0;                                   // инициализация системного таймера (T2, режим CTC)
+    OCR2 = mRTOS_TICK_COUNTS - 1;
+    TIFR = _BV(OCF2);
+    TIMSK |= _BV(OCIE2);                         // разрешить прерывание системного тика
+    TCCR2 = _BV(WGM21) | mRTOS_SYSTEM_TIMER_PRESCALER_VALUE; // запуск системного таймера
+#else
+    TCNT0 = mRTOS_SYSTEM_TIMER_RELOAD_VALUE;     // инициализация системного таймера (T0)
+    TIMSK |= _BV(TOIE0);                         // разрешить прерывание системного тика
+    TCCR0 = mRTOS_SYSTEM_TIMER_PRESCALER_VALUE;  // запуск системного таймера
+#endif
+}
+
+/**
+* Функция перезагрузки таймера системного тика (вызывается в обработчике
+* прерывания тика; T1 и T2 в режиме CTC перезагружаются аппаратно)
+*/
+static inline void mRTOS_PortTickReload(void) {
+#if mRTOS_SYSTEM_TIMER == 0
+    TCNT0 += mRTOS_SYSTEM_TIMER_RELOAD_VALUE; // перезагрузка T0 с сохранением отсчётов, прошедших после переполнения
+#endif
+}
+
+/**
+* Функция чтения отсчётов таймера системного тика от начала текущего тика
+* (вызывается при запрещённых прерываниях или в цикле чтения со счётчиком
+* последовательности)
+* входной параметр:
+* \param CountsPtr - указатель на переменную для отсчётов таймера от начала тика
+* возвращает:
+* \return 1 - тик истёк, прерывание тика ожидает обработки
+* \return 0 - тик не истёк
+*/
+static inline uint8_t mRTOS_PortTickCounts(uint8_t* CountsPtr) {
+    uint8_t ticks = 0, counts = mRTOS_TIMER_COUNTER;
+    if(TIFR & _BV(mRTOS_TIMER_FLAG)) {          // если прерывание тика ещё не обработано, то
+        ticks = 1;                              // тик уже истёк,
+        counts = mRTOS_TIMER_COUNTER;           // таймер считает от нуля (T0 - до перезагрузки в обработчике)
+        if(counts >= mRTOS_TICK_COUNTS)         // если обработчик задержан дольше тика, то
+            counts = mRTOS_TICK_COUNTS - 1;     // ограничить отсчёты текущим тиком
+    } else
+        counts -= mRTOS_TIMER_START;
+    *CountsPtr = counts;
+    return ticks;
+}
+
+/**
+* Функция действия порта в цикле задачи Idle (AVR - нет действия, сон
+* выполняется в режиме без системного тика)
+*/
+static inline void mRTOS_PortIdle(void) {
+}
+
+/**
+* Функция передачи байта трассировки через UART
+* входной параметр:
+* \param Byte - передаваемый байт
+* возвращает:
+* \return 1 - байт передан
+* \return 0 - передатчик занят
+*/
+static inline uint8_t mRTOS_PortTraceOut(uint8_t Byte) {
+    if(!(UCSRA & _BV(UDRE)))                    // если передатчик занят, то
+        return 0;
+    UDR = Byte;
+    return 1;
+}
+
+#endif
+
+#endif
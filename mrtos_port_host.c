@@ -0,0 +1,139 @@
+/******************************************************************************
+* File Name     : 'mrtos_port_host.c'
+* Title         : Linux host port of mRTOS
+* Target MCU    : Linux (host)
+* Editor Tabs   : 4
+*
+* Notes:          Первый запуск задачи выполняется через makecontext и
+*                 setcontext на стеке задачи, последующие переключения -
+*                 через _setjmp/_longjmp (без системных вызовов). Контекст
+*                 функции main сохраняется при запуске mRTOS в последнем
+*                 элементе массива контекстов. Стеки задач выделяются при
+*                 первом создании задачи и используются повторно после
+*                 mRTOS_Init.
+*
+* This code is distributed under the GNU Public License
+* which can be found at http://www.gnu.org/licenses/gpl.txt
+*******************************************************************************/
+
+#undef _FORTIFY_SOURCE                   // _longjmp на стек другой задачи
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <ucontext.h>
+#include "mrtos_port.h"
+#include <inttypes.h>
+#include "mrtos.h"
+
+#if mRTOS_PORT_HOST
+
+volatile uint8_t mRTOS_PortIrq;               // прерывания разрешены (вне критической секции)
+
+static jmp_buf mRTOS_PortJmp[mRTOS_MAX_TASKS + 1];     // контексты задач (последний - функции main)
+static ucontext_t mRTOS_PortStart[mRTOS_MAX_TASKS];    // контексты первого запуска задач
+static void (*mRTOS_PortTask[mRTOS_MAX_TASKS])(void);  // функции задач
+static uint8_t* mRTOS_PortStack[mRTOS_MAX_TASKS];      // стеки задач
+static uint8_t mRTOS_PortStarted[mRTOS_MAX_TASKS];     // задача запущена
+
+/**
+* Функция точки входа в задачу: функция задачи не должна возвращать
+* управление
+*/
+static void mRTOS_PortEntry(void) {
+    mRTOS_PortTask[mRTOS_CurrentTask]();
+    fprintf(stderr, "mRTOS: task %u returned\n", mRTOS_CurrentTask);
+    abort();
+}
+
+/**
+* Функция подготовки контекста задачи: выделение стека (при первом
+* создании задачи) и контекста первого запуска
+* входные параметры:
+* \param Task - указатель на функцию задачи;
+* \param TaskNumber - номер задачи.
+*/
+void mRTOS_PortInitTask(void (*Task)(void), uint8_t TaskNumber) {
+    ucontext_t* ContextPtr = &mRTOS_PortStart[TaskNumber];
+    if(!mRTOS_PortStack[TaskNumber]) {
+        mRTOS_PortStack[TaskNumber] = malloc(mRTOS_PORT_HOST_STACK);
+        if(!mRTOS_PortStack[TaskNumber]) {
+            perror("mRTOS: task stack");
+            exit(1);
+        }
+    }
+    getcontext(ContextPtr);
+    ContextPtr->uc_stack.ss_sp = mRTOS_PortStack[TaskNumber];
+    ContextPtr->uc_stack.ss_size = mRTOS_PORT_HOST_STACK;
+    ContextPtr->uc_link = 0;
+    makecontext(ContextPtr, mRTOS_PortEntry, 0);
+    mRTOS_PortTask[TaskNumber] = Task;
+    mRTOS_PortStarted[TaskNumber] = 0;
+}
+
+/**
+* Функция переключения задач: контекст текущей задачи сохраняется,
+* управление передаётся выбранной задаче; возвращает управление при
+* следующем переключении на текущую задачу
+* входные параметры:
+* \param From - номер текущей задачи (0xFF - функция main);
+* \param To - номер выбранной задачи.
+*/
+void mRTOS_PortSwitch(uint8_t From, uint8_t To) {
+    if(From == 0xFF)                           // при запуске mRTOS - контекст функции main
+        From = mRTOS_MAX_TASKS;
+    if(_setjmp(mRTOS_PortJmp[From]))           // при возврате в текущую задачу
+        return;                                // продолжить её выполнение
+    if(mRTOS_PortStarted[To])
+        _longjmp(mRTOS_PortJmp[To], 1);
+    mRTOS_PortStarted[To] = 1;                 // первый запуск задачи
+    setcontext(&mRTOS_PortStart[To]);
+}
+
+/**
+* Функция запуска виртуальных часов: тики выполняются функцией
+* mRTOS_PortTick, прерывания считаются разрешёнными
+*/
+void mRTOS_PortTickStart(void) {
+    mRTOS_PortIrq = 1;
+}
+
+/**
+* Функция выполнения системного тика виртуальных часов: вызов обработчика
+* тика ядра в критической секции
+*/
+void mRTOS_PortTick(void) {
+    mRTOS_PORT_CRITICAL() {
+        mRTOS_PortTimerIsr();
+    }
+}
+
+/**
+* Функция прохода задачи Idle: время простоя пропускается тиком
+* виртуальных часов
+*/
+void mRTOS_PortIdle(void) {
+    mRTOS_PortTick();
+}
+
+/**
+* Функция вывода байта трассировки: поток записей трассировки выводится
+* в stderr (передатчик всегда свободен)
+* входной параметр:
+* \param Byte - выводимый байт
+* возвращает:
+* \return 1 - байт выведен
+*/
+uint8_t mRTOS_PortTraceOut(uint8_t Byte) {
+    fputc(Byte, stderr);
+    return 1;
+}
+
+/**
+* Функция возврата из mRTOS_Scheduler в функцию main (после запуска
+* mRTOS из функции main)
+*/
+void mRTOS_PortExit(void) {
+    _longjmp(mRTOS_PortJmp[mRTOS_MAX_TASKS], 1);
+}
+
+#endif
@@ -0,0 +1,83 @@
+/******************************************************************************
+* File Name     : 'mrtos_port_host.h'
+* Title         : Linux host port of mRTOS
+* Target MCU    : Linux (host)
+* Editor Tabs   : 4
+*
+* Notes:          Порт ядра для Linux (mRTOS_PORT_HOST = 1): кооперативный
+*                 режим с задачами на собственных стеках (переключение
+*                 _setjmp/_longjmp, первый запуск задачи - makecontext).
+*                 Системный тик - виртуальные часы: тик выполняется функцией
+*                 mRTOS_PortTick (обработчик тика ядра вызывается синхронно
+*                 в критической секции), задача Idle выполняет один тик за
+*                 проход, поэтому время простоя пропускается мгновенно.
+*                 Асинхронных прерываний нет: критическая секция только
+*                 отмечает состояние в mRTOS_PortIrq. Поток трассировки
+*                 выводится в stderr. Функция mRTOS_PortExit возвращает
+*                 управление из mRTOS_Scheduler в функцию main, после чего
+*                 ядро можно инициализировать заново (mRTOS_Init).
+*                 Не поддерживаются: вытесняющий режим, сохранение стека,
+*                 режим без системного тика, контроль стека, быстрые
+*                 события, статическая таблица задач.
+*
+* This code is distributed under the GNU Public License
+* which can be found at http://www.gnu.org/licenses/gpl.txt
+*******************************************************************************/
+
+#ifndef mRTOS_PORT_HOST_H_INCLUDED
+#define mRTOS_PORT_HOST_H_INCLUDED
+
+#include <stdint.h>
+
+#ifndef mRTOS_PORT_HOST_STACK
+#define mRTOS_PORT_HOST_STACK 16384      // размер стека задачи в байтах
+#endif
+
+#define _BV(bit)         (1 << (bit))
+
+// --- критические секции ---
+extern volatile uint8_t mRTOS_PortIrq;   // прерывания разрешены
+
+static inline uint8_t mRTOS_PortCriticalEnter(void) {
+    uint8_t State = mRTOS_PortIrq;
+    mRTOS_PortIrq = 0;
+    return State;
+}
+static inline void mRTOS_PortCriticalExit(const uint8_t* StatePtr) {
+    mRTOS_PortIrq = *StatePtr;
+}
+// критическая секция с восстановлением состояния прерываний при выходе из блока
+#define mRTOS_PORT_CRITICAL() \
+        for(uint8_t mRTOS_PortState __attribute__((__cleanup__(mRTOS_PortCriticalExit))) = mRTOS_PortCriticalEnter(), \
+            mRTOS_PortToDo = 1; mRTOS_PortToDo; mRTOS_PortToDo = 0)
+
+// --- данные во flash ---
+#define PROGMEM
+#define pgm_read_byte(p)  (*(const uint8_t*)(p))
+#define pgm_read_word(p)  (*(const uint16_t*)(p))
+
+// --- системный тик ---
+#define mRTOS_PORT_TICK_ISR()  void mRTOS_PortTimerIsr(void) // обработчик тика вызывается функцией mRTOS_PortTick
+#define mRTOS_PortTickReload()               // виртуальные часы не перезагружаются
+
+/**
+* Функция чтения отсчётов от начала текущего тика: тик виртуальных часов
+* выполняется мгновенно, ожидающих обработки тиков и отсчётов нет
+*/
+static inline uint8_t mRTOS_PortTickCounts(uint8_t* CountsPtr) {
+    *CountsPtr = 0;
+    return 0;
+}
+
+// --- Функции порта ---
+
+void mRTOS_PortInitTask(void (*Task)(void), uint8_t TaskNumber); // функция подготовки контекста задачи (вызывается ядром)
+void mRTOS_PortSwitch(uint8_t From, uint8_t To); // функция переключения задач (From = 0xFF - из функции main, вызывается ядром)
+void mRTOS_PortTimerIsr(void);                   // обработчик системного тика (в ядре)
+void mRTOS_PortTickStart(void);                  // функция запуска виртуальных часов (вызывается ядром)
+void mRTOS_PortTick(void);                       // функция выполнения системного тика виртуальных часов
+void mRTOS_PortIdle(void);                       // функция прохода задачи Idle
+uint8_t mRTOS_PortTraceOut(uint8_t Byte);        // функция вывода байта трассировки в stderr
+void mRTOS_PortExit(void);                       // функция возврата из mRTOS_Scheduler в функцию main
+
+#endif
@@ -0,0 +1,141 @@
+/******************************************************************************
+* File Name     : 'mrtos_queue.c'
+* Title         : Lock-free single producer / single consumer queues of mRTOS
+* Target MCU    : Atmel AVR series
+* Editor Tabs   : 4
+*
+* Notes:          Функции записи и чтения записей фиксированного размера,
+*                 а также блочного доступа к буферу очереди без копирования.
+*                 Функции записи вызывает только производитель, функции
+*                 чтения - только потребитель.
+*
+* This code is distributed under the GNU Public License
+* which can be found at http://www.gnu.org/licenses/gpl.txt
+*******************************************************************************/
+
+#include "mrtos_port.h"
+#include <inttypes.h>
+#include "mrtos.h"
+#include "mrtos_queue.h"
+
+/**
+* Функция записи записи в очередь
+* входные параметры:
+* \param QueuePtr - указатель на структуру очереди
+* \param RecordPtr - указатель на записываемую запись
+* возвращает:
+* \return 1 - запись записана
+* \return 0 - очередь заполнена
+*/
+uint8_t mRTOS_QueuePut(struct Queue* QueuePtr, const void* RecordPtr) {
+    uint8_t head = QueuePtr->Head, i;
+    uint8_t* dst;
+    const uint8_t* src = RecordPtr;
+    if((uint8_t)(head - QueuePtr->Tail) > QueuePtr->Mask) // если очередь заполнена, то
+        return 0;                                        // выход с кодом ошибки
+    dst = QueuePtr->Buffer + (uint16_t)(head & QueuePtr->Mask) * QueuePtr->RecordSize;
+    for(i = QueuePtr->RecordSize; i; i--)                // копировать запись в буфер очереди
+        *dst++ = *src++;
+    mRTOS_QUEUE_BARRIER();
+    QueuePtr->Head = head + 1;                           // опубликовать запись
+    mRTOS_QueueSignal(QueuePtr, head);
+    return 1;
+}
+
+/**
+* Функция чтения записи из очереди
+* входные параметры:
+* \param QueuePtr - указатель на структуру очереди
+* \param RecordPtr - указатель на буфер для прочитанной записи
+* возвращает:
+* \return 1 - запись прочитана
+* \return 0 - очередь пуста
+*/
+uint8_t mRTOS_QueueGet(struct Queue* QueuePtr, void* RecordPtr) {
+    uint8_t tail = QueuePtr->Tail, i;
+    const uint8_t* src;
+    uint8_t* dst = RecordPtr;
+    if(QueuePtr->Head == tail)                           // если очередь пуста, то
+        return 0;                                        // выход с кодом ошибки
+    src = QueuePtr->Buffer + (uint16_t)(tail & QueuePtr->Mask) * QueuePtr->RecordSize;
+    for(i = QueuePtr->RecordSize; i; i--)                // копировать запись из буфера очереди
+        *dst++ = *src++;
+    mRTOS_QUEUE_BARRIER();
+    QueuePtr->Tail = tail + 1;                           // освободить место
+    return 1;
+}
+
+/**
+* Функция получения непрерывного свободного участка буфера очереди для
+* записи без копирования; после заполнения участка записи публикуются
+* функцией mRTOS_QueueWriteCommit
+* входные параметры:
+* \param QueuePtr - указатель на структуру очереди
+* \param BlockPtr - указатель на адрес начала участка
+* возвращает:
+* \return размер участка в записях (0 - очередь заполнена)
+*/
+uint8_t mRTOS_QueueWriteBlock(struct Queue* QueuePtr, void** BlockPtr) {
+    uint8_t offset = QueuePtr->Head & QueuePtr->Mask,
+            count = QueuePtr->Mask + 1 - offset;          // до конца буфера
+    if(count > mRTOS_QueueFree(QueuePtr))                // но не более свободного места
+        count = mRTOS_QueueFree(QueuePtr);
+    *BlockPtr = QueuePtr->Buffer + (uint16_t)offset * QueuePtr->RecordSize;
+    return count;
+}
+
+/**
+* Функция публикации записей, записанных в участок буфера, полученный
+* функцией mRTOS_QueueWriteBlock
+* входные параметры:
+* \param QueuePtr - указатель на структуру очереди
+* \param Count - количество записей
+*/
+void mRTOS_QueueWriteCommit(struct Queue* QueuePtr, uint8_t Count) {
+    uint8_t head = QueuePtr->Head;
+    if(!Count)
+        return;
+    mRTOS_QUEUE_BARRIER();
+    QueuePtr->Head = head + Count;                       // опубликовать записи
+    mRTOS_QueueSignal(QueuePtr, head);
+}
+
+/**
+* Функция получения непрерывного участка буфера очереди с записями для
+* чтения без копирования; после обработки записи освобождаются функцией
+* mRTOS_QueueReadRelease
+* входные параметры:
+* \param QueuePtr - указатель на структуру очереди
+* \param BlockPtr - указатель на адрес начала участка
+* возвращает:
+* \return размер участка в записях (0 - очередь пуста)
+*/
+uint8_t mRTOS_QueueReadBlock(struct Queue* QueuePtr, void** BlockPtr) {
+    uint8_t offset = QueuePtr->Tail & QueuePtr->Mask,
+            count = QueuePtr->Mask + 1 - offset;          // до конца буфера
+    if(count > mRTOS_QueueCount(QueuePtr))               // но не более количества записей
+        count = mRTOS_QueueCount(QueuePtr);
+    *BlockPtr = QueuePtr->Buffer + (uint16_t)offset * QueuePtr->RecordSize;
+    return count;
+}
+
+/**
+* Функция освобождения записей, прочитанных из участка буфера, полученного
+* функцией mRTOS_QueueReadBlock
+* входные параметры:
+* \param QueuePtr - указатель на структуру очереди
+* \param Count - количество записей
+*/
+void mRTOS_QueueReadRelease(struct Queue* QueuePtr, uint8_t Count) {
+    mRTOS_QUEUE_BARRIER();
+    QueuePtr->Tail += Count;                             // освободить места
+}
+
+/**
+* Функция удаления всех записей из очереди
+* входной параметр:
+* \param QueuePtr - указатель на структуру очереди
+*/
+void mRTOS_QueueFlush(struct Queue* QueuePtr) {
+    QueuePtr->Tail = QueuePtr->Head;
+}
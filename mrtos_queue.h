@@ -0,0 +1,133 @@
+/******************************************************************************
+* File Name     : 'mrtos_queue.h'
+* Title         : Lock-free single producer / single consumer queues of mRTOS
+* Target MCU    : Atmel AVR
+* Editor Tabs   : 4
+*
+* Notes:          Очередь с одним производителем и одним потребителем
+*                 (например, прерывание и задача). Индексы записи и чтения -
+*                 8-битные счётчики, каждый из которых изменяет только одна
+*                 сторона, поэтому запись и чтение не требуют запрета
+*                 прерываний. Ёмкость очереди - степень двойки не более 128
+*                 записей фиксированного размера.
+*
+* This code is distributed under the GNU Public License
+* which can be found at http://www.gnu.org/licenses/gpl.txt
+*******************************************************************************/
+
+#ifndef mRTOS_QUEUE_H_INCLUDED
+#define mRTOS_QUEUE_H_INCLUDED
+
+#define mRTOS_QUEUE_NO_EVENT  0xFF   // очередь не связана с событием mRTOS
+
+// --- структура очереди ---
+struct Queue {
+    uint8_t* Buffer;             // буфер записей очереди
+    uint8_t Mask,                // ёмкость очереди в записях - 1
+    RecordSize,                  // размер записи в байтах (1 - очередь байтов)
+    EventNumber;                 // номер события, устанавливаемого при записи в пустую очередь (mRTOS_QUEUE_NO_EVENT - нет)
+    volatile uint8_t Head,       // счётчик записанных записей (изменяет только производитель)
+    Tail;                        // счётчик прочитанных записей (изменяет только потребитель)
+};
+
+// объявление очереди name ёмкостью size записей (степень двойки, 2 .. 128) по recsize байт,
+// связанной с событием event (или mRTOS_QUEUE_NO_EVENT)
+#define mRTOS_QUEUE(name, size, recsize, event) \
+    typedef char name##_size_must_be_power_of_two_up_to_128[(((size) & ((size) - 1)) == 0) && ((size) >= 2) && ((size) <= 128) ? 1 : -1]; \
+    static uint8_t name##_Buffer[(size) * (recsize)]; \
+    struct Queue name = { name##_Buffer, (size) - 1, (recsize), (event), 0, 0 }
+
+// вызов ожидания данных в очереди q с тайм-аутом t тиков (t = 0 - без тайм-аута) в задаче-потребителе;
+// событие очереди должно быть закреплено за задачей функцией mRTOS_InitEvent (или статической таблицей событий)
+#define mRTOS_QUEUE_WAIT(q, t) { \
+    mRTOS_GetEvent((q).EventNumber); \
+    if(mRTOS_QueueCount(&(q)) == 0) \
+        mRTOS_EVENT_WAIT((q).EventNumber, t); \
+}
+
+// барьер компилятора: данные записи должны быть записаны (прочитаны) до изменения индекса
+#define mRTOS_QUEUE_BARRIER()  asm volatile("" ::: "memory")
+
+/**
+* Функция установки события очереди при записи в пустую очередь
+* входные параметры:
+* \param QueuePtr - указатель на структуру очереди
+* \param Head - значение счётчика записанных записей до записи
+*/
+static inline void mRTOS_QueueSignal(struct Queue* QueuePtr, uint8_t Head) {
+    if((Head == QueuePtr->Tail) && (QueuePtr->EventNumber != mRTOS_QUEUE_NO_EVENT)) // если очередь была пуста, то
+        mRTOS_SetEvent(QueuePtr->EventNumber);  // установить событие очереди
+}
+
+/**
+* Функция чтения количества записей в очереди
+* входной параметр:
+* \param QueuePtr - указатель на структуру очереди
+* возвращает:
+* \return количество записей
+*/
+static inline uint8_t mRTOS_QueueCount(struct Queue* QueuePtr) {
+    return (uint8_t)(QueuePtr->Head - QueuePtr->Tail);
+}
+
+/**
+* Функция чтения количества свободных мест в очереди
+* входной параметр:
+* \param QueuePtr - указатель на структуру очереди
+* возвращает:
+* \return количество свободных мест (в записях)
+*/
+static inline uint8_t mRTOS_QueueFree(struct Queue* QueuePtr) {
+    return (uint8_t)(QueuePtr->Mask + 1 - (uint8_t)(QueuePtr->Head - QueuePtr->Tail));
+}
+
+/**
+* Функция записи байта в очередь байтов (вызывается производителем)
+* входные параметры:
+* \param QueuePtr - указатель на структуру очереди
+* \param Data - записываемый байт
+* возвращает:
+* \return 1 - байт записан
+* \return 0 - очередь заполнена
+*/
+static inline uint8_t mRTOS_QueuePutByte(struct Queue* QueuePtr, uint8_t Data) {
+    uint8_t head = QueuePtr->Head;
+    if((uint8_t)(head - QueuePtr->Tail) > QueuePtr->Mask) // если очередь заполнена, то
+        return 0;                                        // выход с кодом ошибки
+    QueuePtr->Buffer[head & QueuePtr->Mask] = Data;      // записать байт
+    mRTOS_QUEUE_BARRIER();
+    QueuePtr->Head = head + 1;                           // опубликовать запись
+    mRTOS_QueueSignal(QueuePtr, head);
+    return 1;
+}
+
+/**
+* Функция чтения байта из очереди байтов (вызывается потребителем)
+* входные параметры:
+* \param QueuePtr - указатель на структуру очереди
+* \param DataPtr - указатель на прочитанный байт
+* возвращает:
+* \return 1 - байт прочитан
+* \return 0 - очередь пуста
+*/
+static inline uint8_t mRTOS_QueueGetByte(struct Queue* QueuePtr, uint8_t* DataPtr) {
+    uint8_t tail = QueuePtr->Tail;
+    if(QueuePtr->Head == tail)                           // если очередь пуста, то
+        return 0;                                        // выход с кодом ошибки
+    *DataPtr = QueuePtr->Buffer[tail & QueuePtr->Mask];  // прочитать байт
+    mRTOS_QUEUE_BARRIER();
+    QueuePtr->Tail = tail + 1;                           // освободить место
+    return 1;
+}
+
+// --- Функции очередей ---
+
+uint8_t mRTOS_QueuePut(struct Queue* QueuePtr, const void* RecordPtr); // функция записи записи в очередь (вызывается производителем)
+uint8_t mRTOS_QueueGet(struct Queue* QueuePtr, void* RecordPtr);       // функция чтения записи из очереди (вызывается потребителем)
+uint8_t mRTOS_QueueWriteBlock(struct Queue* QueuePtr, void** BlockPtr); // функция получения непрерывного свободного участка буфера для записи без копирования
+void mRTOS_QueueWriteCommit(struct Queue* QueuePtr, uint8_t Count);     // функция публикации Count записей, записанных в участок буфера
+uint8_t mRTOS_QueueReadBlock(struct Queue* QueuePtr, void** BlockPtr);  // функция получения непрерывного участка буфера с записями для чтения без копирования
+void mRTOS_QueueReadRelease(struct Queue* QueuePtr, uint8_t Count);     // функция освобождения Count прочитанных записей
+void mRTOS_QueueFlush(struct Queue* QueuePtr);                          // функция удаления всех записей из очереди (вызывается потребителем)
+
+#endif
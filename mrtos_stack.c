@@ -0,0 +1,122 @@
+/******************************************************************************
+* File Name     : 'mrtos_stack.c'
+* Title         : Stack and RAM usage monitor of mRTOS
+* Target MCU    : Atmel AVR series
+* Editor Tabs   : 4
+*
+* Notes:          Границы секций берутся из символов компоновщика avr-libc
+*                 (__data_start, __data_end, __bss_start, __bss_end,
+*                 __heap_start). Область стека окрашивается от __heap_start
+*                 до указателя стека в момент вызова mRTOS_Init; прерывание
+*                 во время окрашивания только затирает окрашенные байты
+*                 ниже указателя стека, которые затем окрашиваются снова.
+*
+* This code is distributed under the GNU Public License
+* which can be found at http://www.gnu.org/licenses/gpl.txt
+*******************************************************************************/
+
+#include "mrtos_port.h"
+#include <inttypes.h>
+#include <stdlib.h>
+#include "mrtos.h"
+#include "mrtos_stack.h"
+
+#if mRTOS_USE_STACK_MONITOR
+
+extern uint8_t __data_start, __data_end, __bss_start, __bss_end, __heap_start; // символы компоновщика
+
+/**
+* Функция окрашивания свободной области стека: от конца .bss до текущего
+* указателя стека (вызывается из mRTOS_Init)
+*/
+void mRTOS_StackPaint(void) {
+    uint8_t* StackPtr = &__heap_start;
+    while(StackPtr < (uint8_t*)SP)          // цикл по свободной области стека
+        *StackPtr++ = mRTOS_STACK_PAINT;
+}
+
+/**
+* Функция чтения наибольшей глубины общего стека: поиск первого байта
+* окрашенной области, изменённого с момента окрашивания
+* возвращает:
+* \return наибольшая глубина стека в байтах (от RAMEND)
+*/
+uint16_t mRTOS_GetStackUsed(void) {
+    uint8_t* StackPtr = &__heap_start;
+    while((StackPtr <= (uint8_t*)RAMEND) && (*StackPtr == mRTOS_STACK_PAINT)) // пропустить не использованные байты
+        StackPtr++;
+    return (uint8_t*)RAMEND + 1 - StackPtr;
+}
+
+/**
+* Функция заполнения отчёта об использовании ОЗУ
+* входной параметр:
+* \param ReportPtr - указатель на структуру отчёта
+*/
+void mRTOS_GetMemReport(struct MemReport* ReportPtr) {
+    ReportPtr->DataSize = &__data_end - &__data_start;
+    ReportPtr->BssSize = &__bss_end - &__bss_start;
+    ReportPtr->StackSize = (uint8_t*)RAMEND + 1 - &__heap_start;
+    ReportPtr->StackUsed = mRTOS_GetStackUsed();
+    ReportPtr->StackFree = ReportPtr->StackSize - ReportPtr->StackUsed;
+}
+
+/**
+* Функция вывода строки отчёта
+* входные параметры:
+* \param PutChar - функция вывода символа;
+* \param s - строка.
+*/
+static void mRTOS_ReportString(void (*PutChar)(char c), const char* s) {
+    while(*s)
+        PutChar(*s++);
+}
+
+/**
+* Функция вывода числа отчёта с предшествующим пробелом
+* входные параметры:
+* \param PutChar - функция вывода символа;
+* \param Value - число.
+*/
+static void mRTOS_ReportNumber(void (*PutChar)(char c), uint16_t Value) {
+    char buf[6];
+    PutChar(' ');
+    mRTOS_ReportString(PutChar, utoa(Value, buf, 10));
+}
+
+/**
+* Функция вывода отчёта об использовании ОЗУ: общие размеры секций и стека,
+* наибольшая глубина стека каждой задачи (и обработчика системного тика)
+* входной параметр:
+* \param PutChar - функция вывода символа (например, передачи через UART)
+*/
+void mRTOS_PrintMemReport(void (*PutChar)(char c)) {
+    struct MemReport report;
+    uint8_t i;
+    mRTOS_GetMemReport(&report);
+    mRTOS_ReportString(PutChar, "MEM data");
+    mRTOS_ReportNumber(PutChar, report.DataSize);
+    mRTOS_ReportString(PutChar, " bss");
+    mRTOS_ReportNumber(PutChar, report.BssSize);
+    mRTOS_ReportString(PutChar, " stack");
+    mRTOS_ReportNumber(PutChar, report.StackSize);
+    mRTOS_ReportString(PutChar, " used");
+    mRTOS_ReportNumber(PutChar, report.StackUsed);
+    mRTOS_ReportString(PutChar, " free");
+    mRTOS_ReportNumber(PutChar, report.StackFree);
+    PutChar('\n');
+    for(i = 0; i < mRTOS_MAX_TASKS; i++) {   // цикл по задачам
+        mRTOS_ReportString(PutChar, "TASK");
+        mRTOS_ReportNumber(PutChar, i);
+        mRTOS_ReportString(PutChar, " used");
+        mRTOS_ReportNumber(PutChar, mRTOS_GetTaskStackUsed(i));
+        PutChar('\n');
+    }
+#if !mRTOS_USE_PREEMPTIVE
+    mRTOS_ReportString(PutChar, "ISR used");
+    mRTOS_ReportNumber(PutChar, mRTOS_GetIsrStackUsed());
+    PutChar('\n');
+#endif
+}
+
+#endif
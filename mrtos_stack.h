@@ -0,0 +1,51 @@
+/******************************************************************************
+* File Name     : 'mrtos_stack.h'
+* Title         : Stack and RAM usage monitor of mRTOS
+* Target MCU    : Atmel AVR
+* Editor Tabs   : 4
+*
+* Notes:          Контроль использования стека (mRTOS_USE_STACK_MONITOR).
+*                 Наибольшая глубина общего стека определяется по границе
+*                 области, окрашенной функцией mRTOS_Init, и учитывает все
+*                 задачи и обработчики прерываний. Глубина стека задачи в
+*                 кооперативном режиме - оценка по отметкам указателя стека
+*                 (между отметками стек может быть глубже), в вытесняющем
+*                 режиме - точное значение по окрашенному стеку задачи.
+*                 Отчёт передаётся функцией вывода символа, например через
+*                 UART, строками:
+*                   MEM data <байт> bss <байт> stack <байт> used <байт> free <байт>
+*                   TASK <номер> used <байт>
+*                   ISR used <байт> (кроме вытесняющего режима)
+*
+* This code is distributed under the GNU Public License
+* which can be found at http://www.gnu.org/licenses/gpl.txt
+*******************************************************************************/
+
+#ifndef mRTOS_STACK_H_INCLUDED
+#define mRTOS_STACK_H_INCLUDED
+
+#if mRTOS_USE_STACK_MONITOR
+
+// --- структура отчёта об использовании ОЗУ ---
+struct MemReport {
+    uint16_t DataSize,           // размер секции .data в байтах
+    BssSize,                     // размер секции .bss в байтах
+    StackSize,                   // размер области стека (от конца .bss до RAMEND) в байтах
+    StackUsed,                   // наибольшая глубина стека в байтах
+    StackFree;                   // ни разу не использованный запас стека в байтах
+};
+
+// --- Функции контроля использования стека ---
+
+void mRTOS_StackPaint(void);                     // функция окрашивания свободной области стека (вызывается из mRTOS_Init)
+uint16_t mRTOS_GetStackUsed(void);               // функция чтения наибольшей глубины общего стека по окрашиванию
+uint16_t mRTOS_GetTaskStackUsed(uint8_t TaskNumber); // функция чтения наибольшей глубины стека задачи под номером TaskNumber
+#if !mRTOS_USE_PREEMPTIVE
+uint16_t mRTOS_GetIsrStackUsed(void);            // функция чтения наибольшей глубины стека в обработчике системного тика
+#endif
+void mRTOS_GetMemReport(struct MemReport* ReportPtr); // функция заполнения отчёта об использовании ОЗУ
+void mRTOS_PrintMemReport(void (*PutChar)(char c));   // функция вывода отчёта об использовании ОЗУ
+
+#endif
+
+#endif
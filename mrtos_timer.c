@@ -0,0 +1,221 @@
+/******************************************************************************
+* File Name     : 'mrtos_timer.c'
+* Title         : Software timers of mRTOS
+* Target MCU    : Atmel AVR series
+* Editor Tabs   : 4
+*
+* Notes:          Сработавшие таймеры остаются в начале списка с нулевым
+*                 приращением задержки до обработки задачей
+*                 mRTOS_TimerService; системный тик пропускает их и
+*                 уменьшает задержку первого не сработавшего таймера.
+*                 Задача обслуживания ожидает семафор mRTOS_TimerSemaphore,
+*                 освобождаемый в системном тике при срабатывании таймера.
+*                 Период автоперезапуска отсчитывается от момента
+*                 срабатывания таймера (по счёту тиков mRTOS_TimerTime), а
+*                 не от его извлечения задачей обслуживания, поэтому
+*                 задержка задачи обслуживания не накапливается; если
+*                 задача обслуживания опоздала на период и более,
+*                 пропущенные срабатывания не выполняются, таймер
+*                 перезапускается до ближайшего момента сетки периода.
+*
+* This code is distributed under the GNU Public License
+* which can be found at http://www.gnu.org/licenses/gpl.txt
+*******************************************************************************/
+
+#include "mrtos_port.h"
+#include <inttypes.h>
+#include "mrtos.h"
+#include "mrtos_timer.h"
+
+#if mRTOS_USE_TIMERS
+
+static struct Timer* mRTOS_TimerHead;                      // первый таймер списка запущенных таймеров
+static uint16_t mRTOS_TimerTime;                           // счёт тиков таймеров (по модулю 65536)
+static struct Semaphore mRTOS_TimerSemaphore = { 0, 0xFF }; // семафор пробуждения задачи обслуживания таймеров
+
+/**
+* Функция включения таймера в список запущенных таймеров (вызывается при
+* запрещённых прерываниях)
+* входные параметры:
+* \param TimerPtr - указатель на структуру таймера;
+* \param Delay - задержка срабатывания в тиках (не 0).
+*/
+static void mRTOS_TimerInsert(struct Timer* TimerPtr, uint16_t Delay) {
+    struct Timer** LinkPtr = &mRTOS_TimerHead;
+    while(*LinkPtr && (Delay >= (*LinkPtr)->Delta)) { // поиск места таймера в списке (после таймеров с тем же временем срабатывания)
+        Delay -= (*LinkPtr)->Delta;
+        LinkPtr = &(*LinkPtr)->Next;
+    }
+    TimerPtr->Delta = Delay;                        // приращение задержки относительно предыдущего таймера
+    TimerPtr->Next = *LinkPtr;
+    if(TimerPtr->Next)                              // если за таймером есть следующий, то
+        TimerPtr->Next->Delta -= Delay;             // уменьшить его приращение задержки
+    *LinkPtr = TimerPtr;
+    TimerPtr->Active = 1;
+}
+
+/**
+* Функция исключения таймера из списка запущенных таймеров (вызывается при
+* запрещённых прерываниях)
+* входной параметр:
+* \param TimerPtr - указатель на структуру запущенного таймера
+*/
+static void mRTOS_TimerRemove(struct Timer* TimerPtr) {
+    struct Timer** LinkPtr = &mRTOS_TimerHead;
+    while(*LinkPtr != TimerPtr)                     // поиск таймера в списке
+        LinkPtr = &(*LinkPtr)->Next;
+    *LinkPtr = TimerPtr->Next;
+    if(TimerPtr->Next)                              // если за таймером есть следующий, то
+        TimerPtr->Next->Delta += TimerPtr->Delta;   // передать ему приращение задержки
+    TimerPtr->Active = 0;
+}
+
+/**
+* Функция инициализации таймера
+* входные параметры:
+* \param TimerPtr - указатель на структуру таймера;
+* \param Callback - функция таймера;
+* \param Period - период автоперезапуска в тиках (0 - однократный таймер).
+*/
+void mRTOS_InitTimer(struct Timer* TimerPtr, void (*Callback)(struct Timer* TimerPtr), uint16_t Period) {
+    mRTOS_PORT_CRITICAL() {
+        if(TimerPtr->Active)                        // если таймер запущен, то
+            mRTOS_TimerRemove(TimerPtr);            // остановить его
+        TimerPtr->Callback = Callback;
+        TimerPtr->Period = Period;
+    }
+}
+
+/**
+* Функция запуска таймера: запущенный таймер перезапускается
+* входные параметры:
+* \param TimerPtr - указатель на структуру таймера;
+* \param Delay - задержка срабатывания в тиках (1...65535).
+* возвращает:
+* \return 1 - таймер запущен
+* \return 0 - ошибка, задержка нулевая
+*/
+uint8_t mRTOS_StartTimer(struct Timer* TimerPtr, uint16_t Delay) {
+    if(!Delay)                                      // если задержка нулевая, то
+        return 0;                                   // выход с кодом ошибки
+    mRTOS_PORT_CRITICAL() {
+        if(TimerPtr->Active)                        // если таймер запущен, то
+            mRTOS_TimerRemove(TimerPtr);            // исключить его из списка
+        mRTOS_TimerInsert(TimerPtr, Delay);         // и включить с новой задержкой
+    }
+    return 1;                                       // выход с кодом успешного выполнения
+}
+
+/**
+* Функция остановки таймера
+* входной параметр:
+* \param TimerPtr - указатель на структуру таймера
+* возвращает:
+* \return 1 - таймер остановлен
+* \return 0 - таймер не был запущен
+*/
+uint8_t mRTOS_StopTimer(struct Timer* TimerPtr) {
+    uint8_t temp = 0;
+    mRTOS_PORT_CRITICAL() {
+        if(TimerPtr->Active) {                      // если таймер запущен, то
+            mRTOS_TimerRemove(TimerPtr);            // исключить его из списка
+            temp = 1;
+        }
+    }
+    return temp;
+}
+
+/**
+* Функция проверки, что таймер запущен
+* входной параметр:
+* \param TimerPtr - указатель на структуру таймера
+* возвращает:
+* \return 1 - таймер запущен (или сработал и ожидает выполнения функции)
+* \return 0 - таймер остановлен
+*/
+uint8_t mRTOS_TimerActive(struct Timer* TimerPtr) {
+    return TimerPtr->Active;
+}
+
+/**
+* Функция отсчёта тиков таймеров: уменьшается задержка первого не
+* сработавшего таймера, при срабатывании таймера пробуждается задача
+* обслуживания (вызывается ядром при запрещённых прерываниях)
+* входной параметр:
+* \param Ticks - количество прошедших системных тиков
+*/
+void mRTOS_TimerTick(uint16_t Ticks) {
+    struct Timer* TimerPtr = mRTOS_TimerHead;
+    uint8_t expired = 0;
+    mRTOS_TimerTime += Ticks;
+    while(TimerPtr && !TimerPtr->Delta)             // пропустить сработавшие таймеры
+        TimerPtr = TimerPtr->Next;
+    while(TimerPtr) {                               // цикл по таймерам, срабатывающим за прошедшие тики
+        if(TimerPtr->Delta > Ticks) {               // если задержка таймера не истекла, то
+            TimerPtr->Delta -= Ticks;               // уменьшить её
+            break;
+        }
+        Ticks -= TimerPtr->Delta;                   // таймер сработал Ticks тиков назад (следующие таймеры с
+                                                    // нулевым приращением - в тот же момент)
+        TimerPtr->Delta = 0;
+        TimerPtr->Expiry = mRTOS_TimerTime - Ticks; // запомнить момент срабатывания
+        expired = 1;
+        TimerPtr = TimerPtr->Next;
+    }
+    if(expired && !mRTOS_TimerSemaphore.Count)      // если таймер сработал, то
+        mRTOS_SignalSemaphore(&mRTOS_TimerSemaphore); // пробудить задачу обслуживания таймеров
+}
+
+/**
+* Функция чтения задержки до срабатывания первого таймера (для режима без
+* системного тика)
+* возвращает:
+* \return задержка в тиках (0 - есть сработавшие таймеры, 0xFFFF - нет
+*         запущенных таймеров)
+*/
+uint16_t mRTOS_TimerDelay(void) {
+    return mRTOS_TimerHead ? mRTOS_TimerHead->Delta : 0xFFFF;
+}
+
+/**
+* Функция извлечения сработавшего таймера из списка; таймер с
+* автоперезапуском включается в список до следующего момента сетки
+* периода, отсчитанного от срабатывания
+* возвращает:
+* \return указатель на структуру сработавшего таймера
+* \return 0 - сработавших таймеров нет
+*/
+static struct Timer* mRTOS_TimerTake(void) __attribute__((noinline));
+static struct Timer* mRTOS_TimerTake(void) {
+    struct Timer* TimerPtr;
+    uint16_t late;
+    mRTOS_PORT_CRITICAL() {
+        TimerPtr = mRTOS_TimerHead;
+        if(TimerPtr && !TimerPtr->Delta) {          // если первый таймер списка сработал, то
+            mRTOS_TimerHead = TimerPtr->Next;       // исключить его из списка
+            TimerPtr->Active = 0;
+            if(TimerPtr->Period) {                  // если таймер с автоперезапуском, то
+                late = (uint16_t)(mRTOS_TimerTime - TimerPtr->Expiry) % TimerPtr->Period; // тиков от срабатывания (в пределах периода)
+                mRTOS_TimerInsert(TimerPtr, TimerPtr->Period - late); // перезапустить его до следующего момента периода
+            }
+        } else
+            TimerPtr = 0;
+    }
+    return TimerPtr;
+}
+
+/**
+* Функция задачи обслуживания таймеров: выполняются функции сработавших
+* таймеров в порядке срабатывания
+*/
+void mRTOS_TimerService(void) {
+    struct Timer* TimerPtr;
+    while(1) {
+        while((TimerPtr = mRTOS_TimerTake()) != 0)  // цикл по сработавшим таймерам
+            if(TimerPtr->Callback)
+                TimerPtr->Callback(TimerPtr);       // выполнить функцию таймера
+        mRTOS_SEMAPHORE_WAIT(mRTOS_TimerSemaphore); // ожидать срабатывания таймера
+    }
+}
+
+#endif
@@ -0,0 +1,56 @@
+/******************************************************************************
+* File Name     : 'mrtos_timer.h'
+* Title         : Software timers of mRTOS
+* Target MCU    : Atmel AVR
+* Editor Tabs   : 4
+*
+* Notes:          Программные таймеры (mRTOS_USE_TIMERS): однократные и с
+*                 автоперезапуском. Функции таймеров вызываются задачей
+*                 mRTOS_TimerService, которую приложение создаёт как обычную
+*                 задачу (или включает в статическую таблицу задач).
+*                 Запущенные таймеры хранятся в списке, упорядоченном по
+*                 времени срабатывания, с приращением задержки относительно
+*                 предыдущего таймера, поэтому системный тик уменьшает
+*                 только задержку первого таймера. Запуск и остановка
+*                 таймера допускаются в задачах и прерываниях.
+*                 Функция таймера выполняется в задаче mRTOS_TimerService и
+*                 не должна ожидать (mRTOS_TASK_WAIT, семафоры и т. п.).
+*
+* This code is distributed under the GNU Public License
+* which can be found at http://www.gnu.org/licenses/gpl.txt
+*******************************************************************************/
+
+#ifndef mRTOS_TIMER_H_INCLUDED
+#define mRTOS_TIMER_H_INCLUDED
+
+// --- структура программного таймера ---
+struct Timer {
+    struct Timer* Next;          // следующий таймер списка запущенных таймеров
+    uint16_t Delta,              // приращение задержки относительно предыдущего таймера списка (0 - таймер сработал)
+    Period,                      // период автоперезапуска в тиках (0 - однократный таймер)
+    Expiry;                      // момент срабатывания по счёту тиков таймеров (для перезапуска без ухода)
+    void (*Callback)(struct Timer* TimerPtr); // функция таймера
+    uint8_t Active;              // таймер запущен (включён в список)
+};
+
+// объявление таймера name с функцией callback и периодом автоперезапуска period тиков
+// (0 - однократный таймер); инициализация во время выполнения не требуется
+#define mRTOS_TIMER(name, callback, period) \
+    struct Timer name = { 0, 0, (period), 0, (callback), 0 }
+
+#if mRTOS_USE_TIMERS
+
+// --- Функции программных таймеров ---
+
+void mRTOS_InitTimer(struct Timer* TimerPtr, void (*Callback)(struct Timer* TimerPtr), uint16_t Period); // функция инициализации таймера
+uint8_t mRTOS_StartTimer(struct Timer* TimerPtr, uint16_t Delay); // функция запуска (перезапуска) таймера на Delay тиков (допускается вызов из прерывания)
+uint8_t mRTOS_StopTimer(struct Timer* TimerPtr);    // функция остановки таймера (допускается вызов из прерывания)
+uint8_t mRTOS_TimerActive(struct Timer* TimerPtr);  // функция проверки, что таймер запущен
+void mRTOS_TimerService(void);                      // функция задачи обслуживания таймеров
+
+void mRTOS_TimerTick(uint16_t Ticks);               // функция отсчёта тиков таймеров (вызывается ядром при запрещённых прерываниях)
+uint16_t mRTOS_TimerDelay(void);                    // функция чтения задержки до срабатывания первого таймера (вызывается ядром)
+
+#endif
+
+#endif
@@ -0,0 +1,193 @@
+/******************************************************************************
+* File Name     : 'mrtos_trace.c'
+* Title         : Context switch trace of mRTOS
+* Target MCU    : Atmel AVR series
+* Editor Tabs   : 4
+*
+* Notes:          Записи добавляет ядро при переключении задач, извлекает
+*                 функция передачи через UART (байт передаёт функция порта
+*                 mRTOS_PortTraceOut, порт Linux выводит поток в stderr).
+*                 При заполнении буфера новые записи не сохраняются, а
+*                 подсчитываются и передаются одной записью mRTOS_TRACE_LOST
+*                 после освобождения места.
+*
+* This code is distributed under the GNU Public License
+* which can be found at http://www.gnu.org/licenses/gpl.txt
+*******************************************************************************/
+
+#include "mrtos_port.h"
+#include <inttypes.h>
+#include "mrtos.h"
+#include "mrtos_trace.h"
+#include "mrtos_port_avr.h"
+
+#if mRTOS_USE_TRACE
+
+#define mRTOS_TRACE_MASK     (mRTOS_TRACE_SIZE - 1) // маска индекса буфера трассировки
+#define mRTOS_TRACE_SYNC     0xA5                   // байт синхронизации записи в потоке UART
+#define mRTOS_TRACE_NO_TASK  0x0F                   // номер задачи до запуска mRTOS
+#define mRTOS_TRACE_FRAME    6                      // размер записи в потоке UART
+
+uint8_t mRTOS_TraceReason;                          // причина следующего переключения задач
+static struct TraceRecord mRTOS_TraceBuffer[mRTOS_TRACE_SIZE]; // буфер трассировки
+static volatile uint8_t mRTOS_TraceHead,            // счётчик записанных записей (индекс записи)
+mRTOS_TraceTail;                                    // счётчик переданных записей (индекс чтения)
+static uint16_t mRTOS_TraceLost;                    // количество потерянных записей
+static uint8_t mRTOS_TraceTask = mRTOS_TRACE_NO_TASK; // задача, выполняемая после последнего переключения
+static uint32_t mRTOS_TraceLastCounts;              // время последнего переключения в отсчётах таймера
+static uint32_t mRTOS_TraceRunTime[mRTOS_MAX_TASKS]; // время выполнения задач в отсчётах таймера
+static uint16_t mRTOS_TraceSwitches[mRTOS_MAX_TASKS]; // количество переключений на задачи
+static uint32_t mRTOS_TraceLoadTotal,               // время и время выполнения задачи Idle
+mRTOS_TraceLoadIdle;                                // на момент предыдущего расчёта загрузки
+static uint8_t mRTOS_TraceFrame[mRTOS_TRACE_FRAME]; // передаваемая через UART запись
+static uint8_t mRTOS_TraceFrameLeft;                // количество не переданных байт записи
+
+/**
+* Функция добавления записи в буфер трассировки (вызывается при запрещённых
+* прерываниях)
+* входные параметры:
+* \param Tasks - номера задач (с которой - ст. тетрада, на которую - мл. тетрада);
+* \param Reason - причина переключения;
+* \param Ticks - младшие 16 бит системного времени в тиках;
+* \param Counts - отсчёты таймера от начала тика.
+* возвращает:
+* \return 1 - запись добавлена
+* \return 0 - буфер заполнен
+*/
+static uint8_t mRTOS_TracePut(uint8_t Tasks, uint8_t Reason, uint16_t Ticks, uint8_t Counts) {
+    struct TraceRecord* RecordPtr;
+    if((uint8_t)(mRTOS_TraceHead - mRTOS_TraceTail) >= mRTOS_TRACE_SIZE) // если буфер заполнен, то
+        return 0;                                   // выход с кодом ошибки
+    RecordPtr = &mRTOS_TraceBuffer[mRTOS_TraceHead & mRTOS_TRACE_MASK];
+    RecordPtr->Tasks = Tasks;
+    RecordPtr->Reason = Reason;
+    RecordPtr->Ticks = Ticks;
+    RecordPtr->Counts = Counts;
+    mRTOS_TraceHead++;
+    return 1;
+}
+
+/**
+* Функция записи переключения задач: учитывается время выполнения
+* предыдущей задачи, в буфер добавляется запись переключения (если выбрана
+* другая задача)
+* входной параметр:
+* \param TaskNumber - номер задачи, на которую выполняется переключение
+*/
+void mRTOS_TraceSwitch(uint8_t TaskNumber) {
+    uint32_t ticks, now;
+    uint8_t counts;
+    mRTOS_PORT_CRITICAL() {
+        if(TaskNumber != mRTOS_TraceTask) {         // если выбрана другая задача, то
+            ticks = mRTOS_GetTraceTime(&counts);
+            now = ticks * mRTOS_TICK_COUNTS + counts; // время в отсчётах таймера
+            if(mRTOS_TraceTask != mRTOS_TRACE_NO_TASK)
+                mRTOS_TraceRunTime[mRTOS_TraceTask] += now - mRTOS_TraceLastCounts; // учесть время выполнения предыдущей задачи
+            mRTOS_TraceLastCounts = now;
+            mRTOS_TraceSwitches[TaskNumber]++;
+            if(mRTOS_TraceLost &&                   // если были потеряны записи, то сообщить их количество
+               mRTOS_TracePut(0xFF, mRTOS_TRACE_LOST, mRTOS_TraceLost, 0))
+                mRTOS_TraceLost = 0;
+            if(mRTOS_TraceLost ||                   // если сообщение о потере не помещено или
+               !mRTOS_TracePut((mRTOS_TraceTask << 4) | TaskNumber, mRTOS_TraceReason, (uint16_t)ticks, counts)) // запись не помещается, то
+                if(mRTOS_TraceLost != 0xFFFF)
+                    mRTOS_TraceLost++;              // учесть потерянную запись
+            mRTOS_TraceTask = TaskNumber;
+        }
+    }
+}
+
+/**
+* Функция передачи буфера трассировки через UART без ожидания: за один вызов
+* передаётся не более одного байта, если передатчик свободен
+* возвращает:
+* \return 1 - есть данные для передачи
+* \return 0 - буфер трассировки передан
+*/
+uint8_t mRTOS_TraceDump(void) {
+    struct TraceRecord* RecordPtr;
+    if(!mRTOS_TraceFrameLeft) {                     // если запись передана, то
+        if(mRTOS_TraceTail == mRTOS_TraceHead)      // если буфер пуст, то
+            return 0;                               // передача завершена
+        RecordPtr = &mRTOS_TraceBuffer[mRTOS_TraceTail & mRTOS_TRACE_MASK]; // подготовить следующую запись
+        mRTOS_TraceFrame[0] = mRTOS_TRACE_SYNC;
+        mRTOS_TraceFrame[1] = RecordPtr->Tasks;
+        mRTOS_TraceFrame[2] = RecordPtr->Reason;
+        mRTOS_TraceFrame[3] = RecordPtr->Ticks;
+        mRTOS_TraceFrame[4] = RecordPtr->Ticks >> 8;
+        mRTOS_TraceFrame[5] = RecordPtr->Counts;
+        mRTOS_TraceTail++;                          // освободить запись в буфере
+        mRTOS_TraceFrameLeft = mRTOS_TRACE_FRAME;
+    }
+    if(mRTOS_PortTraceOut(mRTOS_TraceFrame[mRTOS_TRACE_FRAME - mRTOS_TraceFrameLeft])) // если следующий байт записи передан, то
+        mRTOS_TraceFrameLeft--;
+    return 1;
+}
+
+/**
+* Функция чтения времени выполнения задачи (без учёта текущего интервала
+* выполнения)
+* входной параметр:
+* \param TaskNumber - номер задачи
+* возвращает:
+* \return время выполнения в отсчётах таймера (mRTOS_TICK_COUNTS отсчётов в тике)
+* \return 0 - номер задачи неверный
+*/
+uint32_t mRTOS_GetTaskRunTime(uint8_t TaskNumber) {
+    uint32_t temp = 0;
+    if(TaskNumber >= mRTOS_MAX_TASKS)               // если номер задачи неверный, то
+        return temp;                                // выход с возвратом 0
+    mRTOS_PORT_CRITICAL() {
+        temp = mRTOS_TraceRunTime[TaskNumber];
+    }
+    return temp;
+}
+
+/**
+* Функция чтения количества переключений на задачу
+* входной параметр:
+* \param TaskNumber - номер задачи
+* возвращает:
+* \return количество переключений
+* \return 0 - номер задачи неверный
+*/
+uint16_t mRTOS_GetTaskSwitches(uint8_t TaskNumber) {
+    uint16_t temp = 0;
+    if(TaskNumber >= mRTOS_MAX_TASKS)               // если номер задачи неверный, то
+        return temp;                                // выход с возвратом 0
+    mRTOS_PORT_CRITICAL() {
+        temp = mRTOS_TraceSwitches[TaskNumber];
+    }
+    return temp;
+}
+
+/**
+* Функция чтения загрузки процессора: доля времени, в течение которого
+* не выполнялась задача Idle, с момента предыдущего вызова функции
+* возвращает:
+* \return загрузка процессора в процентах (0 - интервал меньше 100 отсчётов таймера)
+*/
+uint8_t mRTOS_GetCpuLoad(void) {
+    uint32_t ticks, now, idle, total;
+    uint8_t counts;
+    mRTOS_PORT_CRITICAL() {
+        ticks = mRTOS_GetTraceTime(&counts);
+        now = ticks * mRTOS_TICK_COUNTS + counts;
+        idle = mRTOS_TraceRunTime[0];
+        if(mRTOS_TraceTask == 0)                    // если выполняется задача Idle, то
+            idle += now - mRTOS_TraceLastCounts;    // учесть текущий интервал её выполнения
+    }
+    total = now - mRTOS_TraceLoadTotal;             // интервал расчёта
+    mRTOS_TraceLoadTotal = now;
+    now = idle - mRTOS_TraceLoadIdle;               // время выполнения задачи Idle за интервал
+    mRTOS_TraceLoadIdle = idle;
+    total /= 100;
+    if(!total)                                      // если интервал слишком мал, то
+        return 0;                                   // выход с возвратом 0
+    now /= total;                                   // доля времени задачи Idle в процентах
+    if(now > 100)                                   // (с учётом округления интервала)
+        now = 100;
+    return 100 - (uint8_t)now;
+}
+
+#endif
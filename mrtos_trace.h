@@ -0,0 +1,83 @@
+/******************************************************************************
+* File Name     : 'mrtos_trace.h'
+* Title         : Context switch trace of mRTOS
+* Target MCU    : Atmel AVR
+* Editor Tabs   : 4
+*
+* Notes:          Трассировка переключений задач (mRTOS_USE_TRACE): кольцевой
+*                 буфер записей переключений с метками времени, учёт времени
+*                 выполнения и количества переключений задач, загрузка
+*                 процессора по времени выполнения задачи Idle. Буфер
+*                 передаётся через UART функцией mRTOS_TraceDump без ожидания
+*                 (UART инициализируется приложением).
+*                 Формат записи в потоке UART (6 байт):
+*                   0xA5 - байт синхронизации;
+*                   номер задачи, с которой выполнено переключение (ст. тетрада,
+*                   0xF - запуск mRTOS), номер задачи, на которую выполнено
+*                   переключение (мл. тетрада);
+*                   причина переключения (mRTOS_TRACE_xxx);
+*                   мл. и ст. байты младших 16 бит системного времени в тиках;
+*                   отсчёты таймера от начала тика (0 ... mRTOS_TICK_COUNTS - 1).
+*                 Запись с причиной mRTOS_TRACE_LOST сообщает количество
+*                 записей, потерянных при переполнении буфера (в поле времени).
+*                 Декодер записей для компьютера - tools/mrtos_trace.py.
+*                 Не более 15 задач.
+*
+* This code is distributed under the GNU Public License
+* which can be found at http://www.gnu.org/licenses/gpl.txt
+*******************************************************************************/
+
+#ifndef mRTOS_TRACE_H_INCLUDED
+#define mRTOS_TRACE_H_INCLUDED
+
+// --- причины переключения задач ---
+#define mRTOS_TRACE_START      0     // запуск mRTOS
+#define mRTOS_TRACE_DISPATCH   1     // вызов диспетчера задач
+#define mRTOS_TRACE_WAIT       2     // ожидание в состоянии Wait
+#define mRTOS_TRACE_EVENT      3     // ожидание события
+#define mRTOS_TRACE_SEMAPHORE  4     // ожидание семафора
+#define mRTOS_TRACE_MUTEX      5     // ожидание мьютекса
+#define mRTOS_TRACE_PREEMPT    6     // вытеснение в системном тике
+#define mRTOS_TRACE_LOST       7     // записи потеряны при переполнении буфера
+
+#if mRTOS_USE_TRACE
+
+#if mRTOS_MAX_TASKS > 15
+#error "mRTOS: trace supports up to 15 tasks"
+#endif
+#if (mRTOS_TRACE_SIZE & (mRTOS_TRACE_SIZE - 1)) || (mRTOS_TRACE_SIZE > 128)
+#error "mRTOS: mRTOS_TRACE_SIZE must be a power of two up to 128"
+#endif
+
+// --- структура записи буфера трассировки ---
+struct TraceRecord {
+    uint8_t Tasks,               // номера задач: с которой (ст. тетрада) и на которую (мл. тетрада) выполнено переключение
+    Reason;                      // причина переключения
+    uint16_t Ticks;              // младшие 16 бит системного времени в тиках
+    uint8_t Counts;              // отсчёты таймера от начала тика
+};
+
+extern uint8_t mRTOS_TraceReason;                  // причина следующего переключения задач
+
+// установка причины следующего переключения задач (используется ядром)
+#define mRTOS_TRACE_REASON(r)  mRTOS_TraceReason = (r)
+// запись переключения на текущую задачу (используется ядром)
+#define mRTOS_TRACE_SWITCH()   mRTOS_TraceSwitch(mRTOS_CurrentTask)
+
+// --- Функции трассировки ---
+
+void mRTOS_TraceSwitch(uint8_t TaskNumber);        // функция записи переключения на задачу TaskNumber
+uint8_t mRTOS_TraceDump(void);                     // функция передачи буфера трассировки через UART без ожидания
+uint32_t mRTOS_GetTaskRunTime(uint8_t TaskNumber); // функция чтения времени выполнения задачи в отсчётах таймера
+uint16_t mRTOS_GetTaskSwitches(uint8_t TaskNumber); // функция чтения количества переключений на задачу
+uint8_t mRTOS_GetCpuLoad(void);                    // функция чтения загрузки процессора в процентах
+uint32_t mRTOS_GetTraceTime(uint8_t* CountsPtr);  // функция ядра чтения системного времени в тиках и отсчётах таймера от начала тика
+
+#else
+
+#define mRTOS_TRACE_REASON(r)
+#define mRTOS_TRACE_SWITCH()
+
+#endif
+
+#endif
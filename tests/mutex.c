@@ -0,0 +1,70 @@
+/******************************************************************************
+* File Name     : 'mutex.c'
+* Title         : Mutex check of mRTOS on the Linux host port
+* Target MCU    : Linux (host)
+* Editor Tabs   : 4
+*
+* Notes:          Проверка запрета вложенного захвата мьютексов (make
+*                 check-host): задача, владеющая мьютексом A, не должна
+*                 захватить мьютекс B ни функцией mRTOS_TryLockMutex, ни
+*                 функцией mRTOS_LockMutex (действие mRTOS_MUTEX_NESTED при
+*                 сборке проверки пустое); после освобождения A мьютекс B
+*                 захватывается. При ошибке выводится номер шага, код
+*                 возврата - 1.
+*
+* This code is distributed under the GNU Public License
+* which can be found at http://www.gnu.org/licenses/gpl.txt
+*******************************************************************************/
+
+#include <stdio.h>
+#include "mrtos_port.h"
+#include <inttypes.h>
+#include "mrtos.h"
+
+#if !mRTOS_PORT_HOST
+#error "check: build with -DmRTOS_PORT_HOST=1 -D'mRTOS_MUTEX_NESTED(n)='"
+#endif
+
+static struct Mutex CheckMutexA, CheckMutexB;
+static uint8_t CheckFailed;                 // номер первого неудачного шага (0 - ошибок нет)
+
+/**
+* Функция проверки шага
+* входные параметры:
+* \param Step - номер шага
+* \param Ok - результат шага
+*/
+static void CheckStep(uint8_t Step, uint8_t Ok) {
+    if(!Ok && !CheckFailed)
+        CheckFailed = Step;
+}
+
+/**
+* Задача проверки вложенного захвата мьютексов
+*/
+static void check_nested(void) {
+    mRTOS_MUTEX_LOCK(CheckMutexA);
+    CheckStep(1, !mRTOS_TryLockMutex(&CheckMutexB));   // вложенный захват без ожидания отклонён
+    mRTOS_MUTEX_LOCK(CheckMutexB);                     // вложенный захват с ожиданием отклонён без ожидания
+    CheckStep(2, !mRTOS_UnlockMutex(&CheckMutexB));    // мьютекс B не захвачен
+    CheckStep(3, mRTOS_UnlockMutex(&CheckMutexA));
+    CheckStep(4, mRTOS_TryLockMutex(&CheckMutexB));    // без мьютекса A захват B разрешён
+    CheckStep(5, mRTOS_UnlockMutex(&CheckMutexB));
+    mRTOS_PortExit();
+}
+
+int main(void) {
+    mRTOS_Init();
+    mRTOS_InitMutex(&CheckMutexA);
+    mRTOS_InitMutex(&CheckMutexB);
+    mRTOS_CreateTask(check_nested, 10, ACTIVE);
+    mRTOS_Scheduler();                      // возврат после проверки
+
+    if(CheckFailed) {
+        printf("CHECK mutex: step %u failed\n", CheckFailed);
+        printf("CHECK mutex FAILED\n");
+        return 1;
+    }
+    printf("CHECK mutex ok\n");
+    return 0;
+}
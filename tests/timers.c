@@ -0,0 +1,89 @@
+/******************************************************************************
+* File Name     : 'timers.c'
+* Title         : Software timer check of mRTOS on the Linux host port
+* Target MCU    : Linux (host)
+* Editor Tabs   : 4
+*
+* Notes:          Проверка программных таймеров (make check-host): два
+*                 таймера с автоперезапуском запускаются в одном тике с
+*                 одинаковыми задержкой и периодом, поэтому срабатывают в
+*                 одном тике; каждый должен срабатывать в моменты
+*                 CHECK_START + CHECK_PERIOD * k (без ухода фазы). При
+*                 ошибке выводятся моменты срабатывания, код возврата - 1.
+*
+* This code is distributed under the GNU Public License
+* which can be found at http://www.gnu.org/licenses/gpl.txt
+*******************************************************************************/
+
+#include <stdio.h>
+#include "mrtos_port.h"
+#include <inttypes.h>
+#include "mrtos.h"
+#include "mrtos_timer.h"
+
+#if !mRTOS_PORT_HOST || !mRTOS_USE_TIMERS
+#error "check: build with -DmRTOS_PORT_HOST=1 -DmRTOS_USE_TIMERS=1"
+#endif
+
+#define CHECK_START     3       // момент запуска таймеров в тиках
+#define CHECK_PERIOD    10      // задержка и период таймеров в тиках
+#define CHECK_FIRES     4       // количество проверяемых срабатываний каждого таймера
+
+static void CheckCallback(struct Timer* TimerPtr);
+
+static mRTOS_TIMER(CheckTimerA, CheckCallback, CHECK_PERIOD);
+static mRTOS_TIMER(CheckTimerB, CheckCallback, CHECK_PERIOD);
+
+static uint32_t CheckTimes[2][CHECK_FIRES]; // моменты срабатывания таймеров
+static uint8_t CheckCount[2];               // количество срабатываний таймеров
+
+/**
+* Функция таймера: запоминает момент срабатывания; после CHECK_FIRES
+* срабатываний обоих таймеров управление возвращается в функцию main
+* входной параметр:
+* \param TimerPtr - указатель на структуру сработавшего таймера
+*/
+static void CheckCallback(struct Timer* TimerPtr) {
+    uint8_t n = (TimerPtr == &CheckTimerB);
+    if(CheckCount[n] < CHECK_FIRES)
+        CheckTimes[n][CheckCount[n]++] = mRTOS_GetSystemTime();
+    if((CheckCount[0] == CHECK_FIRES) && (CheckCount[1] == CHECK_FIRES))
+        mRTOS_PortExit();
+}
+
+/**
+* Задача запуска таймеров в момент CHECK_START
+*/
+static void check_start(void) {
+    mRTOS_TASK_WAIT_UNTIL(CHECK_START);
+    mRTOS_StartTimer(&CheckTimerA, CHECK_PERIOD);
+    mRTOS_StartTimer(&CheckTimerB, CHECK_PERIOD);
+    while(1)
+        mRTOS_TASK_WAIT(0xFFFF);
+}
+
+int main(void) {
+    uint8_t n, k, fail = 0;
+
+    mRTOS_Init();
+    mRTOS_CreateTask(mRTOS_TimerService, 10, ACTIVE);
+    mRTOS_CreateTask(check_start, 20, ACTIVE);
+    mRTOS_Scheduler();                      // возврат после срабатываний таймеров
+
+    for(n = 0; n < 2; n++)
+        for(k = 0; k < CHECK_FIRES; k++)
+            if(CheckTimes[n][k] != CHECK_START + CHECK_PERIOD * (k + 1u))
+                fail = 1;
+    if(fail) {
+        for(n = 0; n < 2; n++) {
+            printf("CHECK timers: timer %c fired at", 'A' + n);
+            for(k = 0; k < CHECK_FIRES; k++)
+                printf(" %u", CheckTimes[n][k]);
+            printf("\n");
+        }
+        printf("CHECK timers FAILED\n");
+        return 1;
+    }
+    printf("CHECK timers ok\n");
+    return 0;
+}
@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+"""Entry check of the mRTOS cooperative wait functions in an AVR ELF file.
+
+In the cooperative kernel the wait functions (mRTOS_WaitTask,
+mRTOS_WaitSemaphore, mRTOS_LockMutex, ...) and mRTOS_Scheduler pop their
+own return address from the stack in inline assembly (SAVE_RETURN_CONTEXT:
+"pop r0", "pop r1"). The return address is on top of the stack only if the
+compiler emitted no prologue: a push, a stack frame ("in r28, 0x3d",
+"rcall .+0") before the first pop moves it down and the task later resumes
+at a wrong address. The check disassembles the ELF file (avr-objdump -d)
+and fails if any of these instructions precede the first "pop r0"/"pop r1"
+of a listed function. Functions without such a pop (preemptive mode, stack
+save, functions removed by the linker) are skipped.
+
+Exit code: 0 - all entries are clean, 1 - a prologue was found.
+"""
+
+import argparse
+import re
+import subprocess
+import sys
+
+ENTRIES = (
+    "mRTOS_Scheduler",
+    "mRTOS_DispatchTask",
+    "mRTOS_WaitTask",
+    "mRTOS_WaitUntil",
+    "mRTOS_WaitPeriod",
+    "mRTOS_WaitEvent",
+    "mRTOS_WaitSemaphore",
+    "mRTOS_LockMutex",
+    "mRTOS_WaitEventFlags",
+)
+
+FUNCTION = re.compile(r"^[0-9a-f]+ <([^>]+)>:$")
+INSTRUCTION = re.compile(r"^\s*[0-9a-f]+:\s+(?:[0-9a-f]{2} )+\s*(\S+)\s*([^;]*)")
+SP_IO = ("0x3d", "0x3e")        # SPL, SPH
+
+
+def functions(listing):
+    """Instructions (mnemonic, operands) of every function in the listing."""
+    result = {}
+    body = None
+    for line in listing.splitlines():
+        m = FUNCTION.match(line)
+        if m:
+            body = result.setdefault(m.group(1), [])
+            continue
+        m = INSTRUCTION.match(line)
+        if m and body is not None:
+            body.append((m.group(1), re.sub(r"\s", "", m.group(2))))
+    return result
+
+
+def prologue(body):
+    """Stack instructions before the entry pop; None - no entry pop."""
+    found = []
+    for mnemonic, operands in body:
+        if mnemonic == "pop" and operands in ("r0", "r1"):
+            return found
+        if (mnemonic == "push" or
+                (mnemonic == "in" and operands.split(",")[-1] in SP_IO) or
+                (mnemonic == "rcall" and operands == ".+0")):
+            found.append("%s %s" % (mnemonic, operands))
+    return None
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("elf", help="linked AVR ELF file")
+    parser.add_argument("--objdump", default="avr-objdump", help="objdump program")
+    args = parser.parse_args()
+
+    listing = subprocess.run([args.objdump, "-d", args.elf], check=True,
+                             stdout=subprocess.PIPE, universal_newlines=True).stdout
+    bodies = functions(listing)
+    failed = 0
+    for name in ENTRIES:
+        if name not in bodies:
+            continue
+        found = prologue(bodies[name])
+        if found:
+            print("%s: %s: prologue before the return address pop: %s"
+                  % (args.elf, name, ", ".join(found)))
+            failed = 1
+    return failed
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,131 @@
+#!/usr/bin/env python3
+"""Schedulability check of a periodic task set for the mRTOS policies.
+
+Task set file: one task per line, "name C T [priority]" (C - worst-case
+execution time, T - period, both in system ticks; deadline = period, as in
+the kernel EDF policy). Missing priorities are assigned rate monotonic.
+Lines starting with '#' are comments.
+
+Policies (mRTOS_SCHEDULING_POLICY):
+  priority - fixed priorities: response time analysis;
+  edf      - earliest deadline first: utilisation and processor demand.
+The default is the cooperative kernel, where a running task is never
+preempted (non-preemptive analysis with blocking by lower priority or later
+deadline tasks); --preemptive analyses mRTOS_USE_PREEMPTIVE.
+The credit policy has no analysis.
+"""
+
+import argparse
+import math
+import sys
+
+
+class Task:
+    def __init__(self, name, c, t, prio):
+        self.name = name
+        self.c = c
+        self.t = t
+        self.prio = prio
+
+
+def load(lines, overhead):
+    tasks = []
+    for no, line in enumerate(lines, 1):
+        line = line.split("#", 1)[0].split()
+        if not line:
+            continue
+        if len(line) not in (3, 4):
+            sys.exit("line %d: expected 'name C T [priority]'" % no)
+        prio = int(line[3]) if len(line) == 4 else None
+        tasks.append(Task(line[0], float(line[1]) + overhead, int(line[2]), prio))
+    if not tasks:
+        sys.exit("empty task set")
+    by_period = sorted(tasks, key=lambda x: x.t)
+    for rank, task in enumerate(by_period):
+        if task.prio is None:
+            task.prio = 255 - rank          # rate monotonic: shorter period - higher priority
+    return tasks
+
+
+def response_time(task, tasks, preemptive):
+    """Worst-case response time under fixed priorities (None - exceeds the period)."""
+    higher = [x for x in tasks if x is not task and x.prio >= task.prio]  # equal priority: round robin, counted as higher
+    lower = [x for x in tasks if x.prio < task.prio]
+    if preemptive:
+        r = task.c
+        while True:
+            nr = task.c + sum(math.ceil(r / x.t) * x.c for x in higher)
+            if nr > task.t:
+                return None
+            if nr == r:
+                return r
+            r = nr
+    # non-preemptive: blocking by one lower priority job, queueing delay, then the job itself
+    blocking = max([x.c for x in lower] + [task.c])
+    w = blocking
+    while True:
+        nw = blocking + sum((math.floor(w / x.t) + 1) * x.c for x in higher)
+        if nw + task.c > task.t:
+            return None
+        if nw == w:
+            return w + task.c
+        w = nw
+
+
+def check_priority(tasks, preemptive):
+    ok = True
+    print("%-12s %8s %8s %5s %10s" % ("task", "C", "T", "prio", "R"))
+    for task in sorted(tasks, key=lambda x: -x.prio):
+        r = response_time(task, tasks, preemptive)
+        ok &= r is not None
+        print("%-12s %8.2f %8d %5d %10s" % (task.name, task.c, task.t, task.prio,
+                                            "miss" if r is None else "%.2f" % r))
+    return ok
+
+
+def check_edf(tasks, preemptive):
+    u = sum(x.c / x.t for x in tasks)
+    ok = u <= 1.0
+    if ok and not preemptive:
+        # non-preemptive EDF (Jeffay): the longest job started just before the
+        # release of shorter period tasks must not make them miss their deadlines
+        by_period = sorted(tasks, key=lambda x: x.t)
+        for i, task in enumerate(by_period):
+            for length in range(by_period[0].t + 1, task.t):
+                demand = task.c + sum(math.floor((length - 1) / x.t) * x.c for x in by_period[:i])
+                if demand > length:
+                    print("%s: demand %.2f exceeds interval %d" % (task.name, demand, length))
+                    ok = False
+                    break
+    print("utilisation %.3f" % u)
+    return ok
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("taskset", nargs="?", help="task set file (default: stdin)")
+    parser.add_argument("--policy", choices=["priority", "edf", "all"], default="all")
+    parser.add_argument("--preemptive", action="store_true", help="mRTOS_USE_PREEMPTIVE kernel")
+    parser.add_argument("--overhead", type=float, default=0.0,
+                        help="scheduler overhead per job in ticks, added to every C")
+    args = parser.parse_args()
+
+    lines = open(args.taskset).readlines() if args.taskset else sys.stdin.readlines()
+    tasks = load(lines, args.overhead)
+    mode = "preemptive" if args.preemptive else "cooperative"
+    ok = True
+    if args.policy in ("priority", "all"):
+        print("== fixed priority, %s" % mode)
+        res = check_priority(tasks, args.preemptive)
+        print("schedulable" if res else "NOT schedulable")
+        ok &= res
+    if args.policy in ("edf", "all"):
+        print("== EDF, %s" % mode)
+        res = check_edf(tasks, args.preemptive)
+        print("schedulable" if res else "NOT schedulable")
+        ok &= res
+    sys.exit(0 if ok else 1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,115 @@
+#!/usr/bin/env python3
+"""Decoder of the mRTOS context switch trace (mrtos_trace.h).
+
+Reads the byte stream sent by mRTOS_TraceDump (a file, or a serial port
+through pyserial with --port) and prints one line per task switch plus a
+per-task summary of run time and switch count.
+
+Frame (6 bytes): 0xA5, from << 4 | to, reason, ticks low, ticks high, counts.
+"""
+
+import argparse
+import sys
+
+SYNC = 0xA5
+FRAME = 6
+REASONS = ["START", "DISPATCH", "WAIT", "EVENT", "SEMAPHORE", "MUTEX", "PREEMPT", "LOST"]
+
+
+def frames(data):
+    """Yield 5-byte frame bodies, resynchronising on 0xA5."""
+    i = 0
+    while i + FRAME <= len(data):
+        if data[i] != SYNC:
+            i += 1
+            continue
+        body = data[i + 1:i + FRAME]
+        reason = body[1]
+        if reason >= len(REASONS):       # false sync byte inside a frame
+            i += 1
+            continue
+        yield body
+        i += FRAME
+
+
+def task_name(n):
+    return "start" if n == 0xF else "task%d" % n
+
+
+def decode(data, counts_per_tick, tick_us, csv):
+    runtime = {}
+    switches = {}
+    lost_total = 0
+    prev_time = None
+    tick_high = 0
+    prev_ticks = None
+    if csv:
+        print("time_us,from,to,reason")
+    for body in frames(data):
+        tasks, reason, lo, hi, counts = body
+        ticks = lo | hi << 8
+        if reason == 7:                  # mRTOS_TRACE_LOST: ticks holds the lost count
+            lost_total += ticks
+            if csv:
+                print(",,,LOST %d" % ticks)
+            else:
+                print("%12s  %d records lost" % ("", ticks))
+            prev_time = None             # gap in the trace: do not account the interval
+            continue
+        if prev_ticks is not None and ticks < prev_ticks:
+            tick_high += 0x10000         # 16-bit tick counter wrapped
+        prev_ticks = ticks
+        time_us = ((tick_high + ticks) * counts_per_tick + counts) * tick_us / counts_per_tick
+        src, dst = tasks >> 4, tasks & 0x0F
+        if prev_time is not None and src != 0xF:
+            runtime[src] = runtime.get(src, 0.0) + time_us - prev_time
+        prev_time = time_us
+        switches[dst] = switches.get(dst, 0) + 1
+        if csv:
+            print("%.1f,%s,%s,%s" % (time_us, task_name(src), task_name(dst), REASONS[reason]))
+        else:
+            print("%12.1f  %-6s -> %-6s %s" % (time_us, task_name(src), task_name(dst), REASONS[reason]))
+
+    total = sum(runtime.values())
+    if csv or not switches:
+        return
+    print()
+    print("%-6s %12s %7s %9s" % ("task", "run_us", "load%", "switches"))
+    for n in sorted(set(runtime) | set(switches)):
+        us = runtime.get(n, 0.0)
+        print("%-6s %12.1f %7.1f %9d" % (task_name(n), us, 100.0 * us / total if total else 0.0,
+                                         switches.get(n, 0)))
+    if lost_total:
+        print("lost records: %d" % lost_total)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("input", nargs="?", help="binary trace file (default: stdin)")
+    parser.add_argument("--port", help="read from a serial port instead of a file")
+    parser.add_argument("--baud", type=int, default=38400)
+    parser.add_argument("--seconds", type=float, default=5.0, help="serial capture time")
+    parser.add_argument("--counts-per-tick", type=int, default=250,
+                        help="mRTOS_TICK_COUNTS, F_CPU / prescaler / mRTOS_TICK_HZ")
+    parser.add_argument("--tick-us", type=float, default=1000.0, help="system tick length in microseconds")
+    parser.add_argument("--csv", action="store_true", help="print switches as CSV without summary")
+    args = parser.parse_args()
+
+    if args.port:
+        import serial
+        import time
+        data = bytearray()
+        with serial.Serial(args.port, args.baud, timeout=0.1) as port:
+            end = time.time() + args.seconds
+            while time.time() < end:
+                data += port.read(256)
+    elif args.input:
+        with open(args.input, "rb") as f:
+            data = f.read()
+    else:
+        data = sys.stdin.buffer.read()
+    decode(bytes(data), args.counts_per_tick, args.tick_us, args.csv)
+
+
+if __name__ == "__main__":
+    main()